@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+===============================================================================
+  PETRI NET SOLVER - SCALABLE MODEL GENERATOR
+  Sinh các file PNML có kích thước tùy chỉnh để benchmark các engine
+
+  Usage:
+    python3 scripts/gen_models.py philosophers 10          # 10 triết gia
+    python3 scripts/gen_models.py cycles 6 4               # 6 vòng, mỗi vòng 4 place
+    python3 scripts/gen_models.py ring 8                   # token ring 8 trạm
+    python3 scripts/gen_models.py pipeline 5 3             # 5 stage, buffer 3 slot
+    python3 scripts/gen_models.py workflow 6 8             # fork 6 nhánh, mỗi nhánh 8 task, join
+    python3 scripts/gen_models.py philosophers 10 --out bench/models
+===============================================================================
+"""
+
+import argparse
+import os
+
+
+class Net:
+    def __init__(self, name):
+        self.name = name
+        self.places = []        # (id, tokens)
+        self.transitions = []
+        self.arcs = []          # (source, target, weight)
+
+    def place(self, pid, tokens=0):
+        self.places.append((pid, tokens))
+        return pid
+
+    def transition(self, tid, inputs, outputs):
+        self.transitions.append(tid)
+        for p in inputs:
+            self.arcs.append((p, tid, 1))
+        for p in outputs:
+            self.arcs.append((tid, p, 1))
+        return tid
+
+    def to_pnml(self, comment):
+        out = ['<?xml version="1.0" encoding="UTF-8"?>',
+               f'<!-- {comment} -->',
+               '<pnml xmlns="http://www.pnml.org/version-2009/grammar/pnml">',
+               f'  <net id="{self.name}" type="http://www.pnml.org/version-2009/grammar/ptnet">',
+               '    <page id="page1">']
+        for pid, tokens in self.places:
+            if tokens:
+                out.append(f'      <place id="{pid}"><initialMarking><text>{tokens}</text></initialMarking></place>')
+            else:
+                out.append(f'      <place id="{pid}"></place>')
+        for tid in self.transitions:
+            out.append(f'      <transition id="{tid}"></transition>')
+        for i, (s, t, w) in enumerate(self.arcs):
+            if w == 1:
+                out.append(f'      <arc id="a{i}" source="{s}" target="{t}"/>')
+            else:
+                out.append(f'      <arc id="a{i}" source="{s}" target="{t}">'
+                           f'<inscription><text>{w}</text></inscription></arc>')
+        out += ['    </page>', '  </net>', '</pnml>', '']
+        return '\n'.join(out)
+
+
+def philosophers(n):
+    """Triết gia lấy đũa trái rồi đũa phải (có deadlock)."""
+    net = Net(f"philosophers{n}")
+    for i in range(n):
+        net.place(f"think{i}", 1)
+        net.place(f"hasLeft{i}")
+        net.place(f"eat{i}")
+        net.place(f"fork{i}", 1)
+    for i in range(n):
+        left, right = f"fork{i}", f"fork{(i + 1) % n}"
+        net.transition(f"takeLeft{i}", [f"think{i}", left], [f"hasLeft{i}"])
+        net.transition(f"takeRight{i}", [f"hasLeft{i}", right], [f"eat{i}"])
+        net.transition(f"release{i}", [f"eat{i}"], [f"think{i}", left, right])
+    return net, f"Dining Philosophers ({n}), left-then-right, deadlocks"
+
+
+def cycles(k, length):
+    """k vòng độc lập, mỗi vòng `length` place và 1 token."""
+    net = Net(f"cycles{k}x{length}")
+    for c in range(k):
+        for j in range(length):
+            net.place(f"c{c}_p{j}", 1 if j == 0 else 0)
+        for j in range(length):
+            net.transition(f"c{c}_t{j}", [f"c{c}_p{j}"], [f"c{c}_p{(j + 1) % length}"])
+    return net, f"{k} independent cycles of length {length} ({length ** k} states)"
+
+
+def ring(n):
+    """Token ring: mỗi trạm idle/wait/critical, token đi vòng."""
+    net = Net(f"ring{n}")
+    for i in range(n):
+        net.place(f"idle{i}", 1)
+        net.place(f"wait{i}")
+        net.place(f"crit{i}")
+        net.place(f"token{i}", 1 if i == 0 else 0)
+    for i in range(n):
+        nxt = (i + 1) % n
+        net.transition(f"request{i}", [f"idle{i}"], [f"wait{i}"])
+        net.transition(f"enter{i}", [f"wait{i}", f"token{i}"], [f"crit{i}"])
+        net.transition(f"leave{i}", [f"crit{i}"], [f"idle{i}", f"token{nxt}"])
+        net.transition(f"pass{i}", [f"idle{i}", f"token{i}"], [f"idle{i}", f"token{nxt}"])
+    return net, f"Token ring ({n} stations)"
+
+
+def pipeline(stages, slots):
+    """Pipeline `stages` giai đoạn, mỗi buffer có `slots` ô 1-safe."""
+    net = Net(f"pipeline{stages}x{slots}")
+    for s in range(stages):
+        for k in range(slots):
+            net.place(f"s{s}_full{k}")
+            net.place(f"s{s}_free{k}", 1)
+    for k in range(slots):
+        net.transition(f"produce{k}", [f"s0_free{k}"], [f"s0_full{k}"])
+        for s in range(stages - 1):
+            net.transition(f"move{s}_{k}", [f"s{s}_full{k}", f"s{s + 1}_free{k}"],
+                           [f"s{s}_free{k}", f"s{s + 1}_full{k}"])
+        net.transition(f"consume{k}", [f"s{stages - 1}_full{k}"], [f"s{stages - 1}_free{k}"])
+    return net, f"Pipeline ({stages} stages x {slots} slots)"
+
+
+def workflow(branches, length):
+    """Workflow không vòng: fork `branches` nhánh song song, mỗi nhánh `length` task, rồi join."""
+    net = Net(f"workflow{branches}x{length}")
+    net.place("start", 1)
+    net.place("done")
+    for b in range(branches):
+        for j in range(length + 1):
+            net.place(f"b{b}_p{j}")
+    net.transition("fork", ["start"], [f"b{b}_p0" for b in range(branches)])
+    for b in range(branches):
+        for j in range(length):
+            net.transition(f"b{b}_t{j}", [f"b{b}_p{j}"], [f"b{b}_p{j + 1}"])
+    net.transition("join", [f"b{b}_p{length}" for b in range(branches)], ["done"])
+    return net, f"Workflow ({branches} parallel branches x {length} tasks, {(length + 1) ** branches + 2} states)"
+
+
+GENERATORS = {
+    "philosophers": (philosophers, 1),
+    "cycles": (cycles, 2),
+    "ring": (ring, 1),
+    "pipeline": (pipeline, 2),
+    "workflow": (workflow, 2),
+}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate scalable PNML benchmark models")
+    parser.add_argument("kind", choices=sorted(GENERATORS))
+    parser.add_argument("params", type=int, nargs="+")
+    parser.add_argument("--out", default="bench/models", help="output directory")
+    args = parser.parse_args()
+
+    gen, arity = GENERATORS[args.kind]
+    if len(args.params) != arity:
+        parser.error(f"{args.kind} takes {arity} integer parameter(s)")
+
+    net, comment = gen(*args.params)
+    os.makedirs(args.out, exist_ok=True)
+    path = os.path.join(args.out, net.name + ".pnml")
+    with open(path, "w", encoding="utf-8") as f:
+        f.write(net.to_pnml(comment))
+    print(f"{path}: {len(net.places)} places, {len(net.transitions)} transitions, {len(net.arcs)} arcs")
+
+
+if __name__ == "__main__":
+    main()
@@ -13,18 +13,12 @@ if (Test-Path $csvPath) {
     Write-Host "Cleared old result.csv" -ForegroundColor Yellow
 }
 
-# Get all PNML files
-$pnmlFiles = Get-ChildItem -Path "data" -Filter "*.pnml" | Sort-Object Name
-
-Write-Host "Found $($pnmlFiles.Count) test files" -ForegroundColor Green
+# Run every model in one process (single consolidated result.csv)
+$jobs = [Environment]::ProcessorCount
+Write-Host "Running batch over data\ ($jobs workers requested)" -ForegroundColor Green
+Write-Host ""
+& ".\bin\petri_solver.exe" --batch "data" --mode all --jobs $jobs
 Write-Host ""
-
-# Run each test
-foreach ($file in $pnmlFiles) {
-    Write-Host "Testing: $($file.Name)" -ForegroundColor White
-    & ".\bin\petri_solver.exe" --input "data\$($file.Name)" --mode all
-    Write-Host ""
-}
 
 Write-Host "========================================" -ForegroundColor Cyan
 Write-Host "  ALL TESTS COMPLETED!" -ForegroundColor Green
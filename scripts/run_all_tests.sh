@@ -0,0 +1,23 @@
+#!/usr/bin/env bash
+# Shell script to run all test cases (Linux/macOS)
+# Usage: ./scripts/run_all_tests.sh [jobs]
+
+set -e
+
+JOBS="${1:-$(nproc 2>/dev/null || sysctl -n hw.ncpu 2>/dev/null || echo 1)}"
+
+echo "========================================"
+echo "  PETRI NET SOLVER - RUN ALL TESTS"
+echo "========================================"
+echo ""
+
+# Batch mode rewrites output/result.csv with one consolidated table
+./bin/petri_solver --batch data --mode all --jobs "$JOBS"
+
+echo ""
+echo "========================================"
+echo "  ALL TESTS COMPLETED!"
+echo "  Results saved to: output/result.csv"
+echo "========================================"
+echo ""
+echo "Run 'python3 scripts/analyze_results.py' to generate charts"
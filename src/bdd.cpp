@@ -5,64 +5,391 @@
 
 #include "bdd.h"
 #include "utils.h"
+#include "logger.h"
 #include "buddy/bdd.h"
+#include "buddy/bvec.h"
+#include <algorithm>
 #include <iostream>
 #include <chrono>
+#include <cstdio>
+#include <cinttypes>
+#include <vector>
+
+#ifndef _WIN32
+    #include <cerrno>
+    #include <csignal>
+    #include <poll.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif
+
+static const int REACH_CACHE_VERSION = 3;
+
+// ======== K-BOUNDED ENCODING ========
+// A place holding 0..k tokens takes bits = bitsForBound(k) variable pairs,
+// least significant bit first: bit j of place p is current-state variable
+// 2(p*bits + j) (even) and next-state variable 2(p*bits + j) + 1 (odd).
+// With k = 1 this is one pair per place, as for 1-safe nets.
+
+static int currVar(int p, int j, int bits) { return 2 * (p * bits + j); }
 
 // Convert marking to BDD (conjunction of variable assignments)
-bdd markingToBdd(const Marking& m, int numPlaces) {
+bdd markingToBdd(const Marking& m, int numPlaces, int bits = 1) {
     bdd result = bdd_true();
     for (int i = 0; i < numPlaces; ++i) {
-        int varIdx = i * 2; // Biến chẵn: trạng thái hiện tại (x)
+        for (int j = 0; j < bits; ++j) {
+            int varIdx = currVar(i, j, bits); // Biến chẵn: trạng thái hiện tại (x)
 
-        // Logic 1-safe: 
-        // Nếu có token (1) -> AND với biến x
-        // Nếu không có (0) -> AND với phủ định !x
-        if (m[i] > 0) {
-            result &= bdd_ithvar(varIdx);
-        }
-        else {
-            result &= bdd_nithvar(varIdx);
+            // Bit j của số token: 1 -> AND với biến x, 0 -> AND với phủ định !x
+            if ((m[i] >> j) & 1)
+                result &= bdd_ithvar(varIdx);
+            else
+                result &= bdd_nithvar(varIdx);
         }
     }
     return result;
 }
 
-// Main symbolic reachability algorithm
-BddResult bddReach(const Model& net, const BddOptions& opts) {
-    auto start_time = std::chrono::high_resolution_clock::now();
+// ======== PERSISTENT REACHED-SET CACHE ========
+// File = one header line "PNREACH <version> <key> <numVars> <iters> <tokenBound>"
+// followed by bdd_savebin output (variable order, level-grouped varint nodes).
 
-    BddResult res;
-    int numPlaces = net.places.size();
-    int numVars = numPlaces * 2;  // Current (even) + Next (odd) vars
+static std::string reachCachePath(const std::string& dir, uint64_t key) {
+    char name[40];
+    snprintf(name, sizeof(name), "reach-%016" PRIx64 ".bdd", key);
+    std::string path = dir;
+    if (!path.empty() && path.back() != '/' && path.back() != '\\') path += '/';
+    return path + name;
+}
 
-    // Initialize BuDDy
-    if (!bdd_isrunning()) {
-        bdd_init(1000000, 100000);
-        bdd_setvarnum(numVars);
+// Returns false on missing, stale or malformed cache (Reached untouched).
+// tokenBound 0 accepts whatever bound the cache was computed with and
+// returns it there.
+static bool loadReachedCache(const std::string& path, uint64_t key, int numPlaces,
+                             int& tokenBound, bdd& reached, int& iters) {
+    FILE* in = fopen(path.c_str(), "rb");
+    if (!in) return false;
+
+    int version = 0, vars = 0, savedIters = 0, savedBound = 0;
+    uint64_t savedKey = 0;
+    bool ok = fscanf(in, "PNREACH %d %" SCNx64 " %d %d %d", &version, &savedKey, &vars,
+                     &savedIters, &savedBound) == 5
+              && fgetc(in) == '\n'
+              && version == REACH_CACHE_VERSION && savedKey == key
+              && savedBound >= 1 && savedBound <= MAX_TOKENS
+              && (tokenBound == 0 || savedBound == tokenBound)
+              && vars == 2 * numPlaces * bitsForBound(savedBound);
+
+    if (ok) {
+        if (bdd_varnum() < vars) bdd_extvarnum(vars - bdd_varnum());
+        // Format errors must not hit the default handler, which exits
+        bddinthandler oldHandler = bdd_error_hook(NULL);
+        bdd loaded;
+        ok = bdd_loadbin(in, loaded) == 0;
+        bdd_error_hook(oldHandler);
+        if (ok) {
+            reached = loaded;
+            iters = savedIters;
+            tokenBound = savedBound;
+        }
     }
+    fclose(in);
+    return ok;
+}
 
-    // Encode initial marking M0
-    bdd M0_bdd = markingToBdd(net.M0, numPlaces);
+static void saveReachedCache(const std::string& path, uint64_t key, int numVars,
+                             int tokenBound, const bdd& reached, int iters) {
+    std::string tmpPath = path + ".tmp";
+    FILE* out = fopen(tmpPath.c_str(), "wb");
+    if (!out) {
+        std::cerr << "[BDD] Warning: cannot write reach cache " << path << std::endl;
+        return;
+    }
+    fprintf(out, "PNREACH %d %016" PRIx64 " %d %d %d\n", REACH_CACHE_VERSION, key, numVars,
+            iters, tokenBound);
+    bool ok = bdd_savebin(out, reached) == 0;
+    ok = (fclose(out) == 0) && ok;
 
-    // Build transition relation: TR = OR of all transitions
-    bdd TR = bdd_false();
+    remove(path.c_str());
+    if (!ok || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        remove(tmpPath.c_str());
+        std::cerr << "[BDD] Warning: cannot write reach cache " << path << std::endl;
+    }
+}
 
-    // Variable renaming pairs for next->current substitution
-    bddPair* pairs = bdd_newpair();
-    for (int i = 0; i < numPlaces; ++i) {
-        // Map biến lẻ (Next - 2i+1) về biến chẵn (Curr - 2i)
-        bdd_setpair(pairs, i * 2 + 1, i * 2);
+// ======== FIXPOINT CHECKPOINTS ========
+// File = header line "PNCKPT <version> <key> <numVars> <iters> <tokenBound> <capped> <count>"
+// followed by bdd_savebin of Reached, then of New. Written to a temporary file
+// and renamed, so an interrupted save leaves the previous checkpoint. Removed
+// once the fixpoint is reached; a partial run (memory limit, maxIters) keeps it.
+
+static const int CHECKPOINT_VERSION = 1;
+
+struct FixpointCheckpoint {
+    std::string path;         // Empty: no checkpoints
+    uint64_t key = 0;
+    double intervalSec = 0;
+    bool resumed = false;     // State below was loaded and not yet used
+    bdd reached, frontier;
+    int iters = 0;
+    double count = 0;
+};
+
+static std::string checkpointPath(const std::string& dir, uint64_t key) {
+    char name[40];
+    snprintf(name, sizeof(name), "bdd-%016" PRIx64 ".ckpt", key);
+    std::string path = dir;
+    if (!path.empty() && path.back() != '/' && path.back() != '\\') path += '/';
+    return path + name;
+}
+
+// tokenBound 0 accepts the checkpoint's bound and returns it there
+static bool loadCheckpoint(FixpointCheckpoint& ckpt, int numPlaces, int& tokenBound, bool& capped) {
+    FILE* in = fopen(ckpt.path.c_str(), "rb");
+    if (!in) return false;
+
+    int version = 0, vars = 0, iters = 0, bound = 0, wasCapped = 0;
+    uint64_t key = 0;
+    double count = 0;
+    bool ok = fscanf(in, "PNCKPT %d %" SCNx64 " %d %d %d %d %lf", &version, &key, &vars, &iters,
+                     &bound, &wasCapped, &count) == 7
+              && fgetc(in) == '\n'
+              && version == CHECKPOINT_VERSION && key == ckpt.key
+              && bound >= 1 && bound <= MAX_TOKENS && (tokenBound == 0 || bound == tokenBound)
+              && vars == 2 * numPlaces * bitsForBound(bound);
+    if (ok) {
+        if (bdd_varnum() < vars) bdd_extvarnum(vars - bdd_varnum());
+        bddinthandler oldHandler = bdd_error_hook(NULL);
+        bdd reached, frontier;
+        ok = bdd_loadbin(in, reached) == 0 && bdd_loadbin(in, frontier) == 0;
+        bdd_error_hook(oldHandler);
+        if (ok) {
+            ckpt.reached = reached;
+            ckpt.frontier = frontier;
+            ckpt.iters = iters;
+            ckpt.count = count;
+            ckpt.resumed = true;
+            tokenBound = bound;
+            capped = wasCapped != 0;
+        }
     }
+    fclose(in);
+    return ok;
+}
 
-    // Encode each transition
-    for (size_t t = 0; t < net.transitions.size(); ++t) {
-        bdd trans_t = bdd_true();
-        for (int p = 0; p < numPlaces; ++p) {
-            int curr = p * 2;      // Current state var
-            int next = p * 2 + 1;  // Next state var
-            int preVal = net.Pre[p][t];
-            int postVal = net.Post[p][t];
+static void saveCheckpoint(const FixpointCheckpoint& ckpt, int numVars, int tokenBound, bool capped,
+                           const bdd& reached, const bdd& frontier, int iters, double count) {
+    std::string tmpPath = ckpt.path + ".tmp";
+    FILE* out = fopen(tmpPath.c_str(), "wb");
+    bool ok = out != nullptr;
+    if (ok) {
+        fprintf(out, "PNCKPT %d %016" PRIx64 " %d %d %d %d %.17g\n", CHECKPOINT_VERSION, ckpt.key,
+                numVars, iters, tokenBound, capped ? 1 : 0, count);
+        ok = bdd_savebin(out, reached) == 0 && bdd_savebin(out, frontier) == 0;
+        ok = (fclose(out) == 0) && ok;
+    }
+    if (!ok || rename(tmpPath.c_str(), ckpt.path.c_str()) != 0) {
+        remove(tmpPath.c_str());
+        LOG_WARN("[BDD] Cannot write checkpoint " << ckpt.path);
+    }
+}
+
+// ======== KERNEL SIZING ========
+// A node costs 20 bytes (node + unique-table bucket head in either layout)
+// plus 12 for its bdd_satcount table entries, an operator cache entry 24 bytes,
+// and BuDDy keeps six operator caches.
+
+static const double NODE_BYTES = 32.0;
+static const double CACHE_ENTRY_BYTES = 24.0;
+static const int OP_CACHES = 6;
+
+// Memory per node when the caches follow the table at the given ratio
+static double bytesPerNode(int cacheRatio) {
+    return NODE_BYTES + OP_CACHES * CACHE_ENTRY_BYTES / cacheRatio;
+}
+
+BddKernelParams tuneBddKernel(const Model& net, int tokenBound, double memBudgetMB) {
+    BddKernelParams p;
+
+    // The transition relation takes about one node per variable per
+    // transition; reached sets usually need a few dozen times that
+    double vars = 2.0 * net.places.size() * bitsForBound(tokenBound);
+    double trNodes = (double)std::max<size_t>(net.transitions.size(), 1) * vars;
+    double nodes = std::min(std::max(64.0 * trNodes, 16384.0), 2097152.0);
+
+    // Caches follow the table as it grows instead of staying at their initial size
+    p.cacheRatio = 8;
+
+    // Doubling on each resize; BuDDy's default step of 50000 nodes makes a
+    // multi-million-node run resize and rehash dozens of times
+    double maxIncrease = 8388608.0;
+
+    if (memBudgetMB > 0) {
+        double budgetNodes = memBudgetMB * 1024.0 * 1024.0 / bytesPerNode(p.cacheRatio);
+        // Start at no more than half of the budget so the table can still grow once
+        nodes = std::max(std::min(nodes, budgetNodes / 2), 1024.0);
+        maxIncrease = std::max(std::min(maxIncrease, budgetNodes - nodes), 1024.0);
+    }
+
+    p.nodes = (int)nodes;
+    p.cacheSize = std::max(p.nodes / p.cacheRatio, 1024);
+    p.maxIncrease = (int)maxIncrease;
+    // Big nets grow earlier: a GC over millions of nodes that frees little is wasted
+    p.minFreePct = trNodes >= 4096 ? 30 : 20;
+    return p;
+}
+
+// ======== MEMORY LIMIT ========
+// With a memory limit the node table is capped by bdd_setmaxnodenum. When it
+// is full BuDDy reports BDD_NODENUM and every later operation returns
+// bddfalse until bdd_clear_error. The fixpoint checks for that after each
+// step, drops the half-computed result, sifts the variable order once to
+// make room and retries the step; if that is not enough it stops and
+// returns the Reached set found so far as a partial result.
+
+static int pendingBddError = 0;                 // First error raised in the current step
+static bddinthandler outerErrHandler = nullptr; // Handler for errors that are not recorded
+
+static void recordBddError(int e) {
+    if (e != BDD_NODENUM && outerErrHandler != nullptr) {
+        outerErrHandler(e);
+        return;
+    }
+    if (pendingBddError == 0) pendingBddError = e;
+}
+
+static void clearBddError() {
+    pendingBddError = 0;
+    bdd_clear_error();
+}
+
+// Sift the (x, x') pairs as blocks to shrink the live BDDs; true if the
+// table has room again
+static bool reorderForSpace(int numPairs) {
+    clearBddError();
+    int before = bdd_getnodenum();
+    for (int i = 0; i < numPairs; ++i)
+        bdd_intaddvarblock(i * 2, i * 2 + 1, BDD_REORDER_FIXED);
+    bdd_reorder(BDD_REORDER_SIFT);
+    bdd_clrvarblocks();
+    bool ok = pendingBddError == 0;
+    clearBddError();
+    bdd_gbc();
+    LOG_WARN("[BDD] Node table full, reordered variables: " << before << " -> "
+             << bdd_getnodenum() << " nodes" << (ok ? "" : " (reorder failed)"));
+    return ok;
+}
+
+// Put the (x, x') pairs of the places in the given order, bits of a place
+// together; variables of other models in a shared kernel go below, in
+// their current order. Only levels move, so every BDD stays valid.
+static void applyPlaceOrder(const std::vector<int>& order, int bits) {
+    std::vector<int> neworder;
+    std::vector<bool> taken(bdd_varnum(), false);
+    for (int p : order) {
+        for (int j = 0; j < bits; ++j) {
+            int v = currVar(p, j, bits);
+            neworder.push_back(v);
+            neworder.push_back(v + 1);
+            taken[v] = taken[v + 1] = true;
+        }
+    }
+    std::vector<int> rest;
+    for (int v = 0; v < bdd_varnum(); ++v)
+        if (!taken[v]) rest.push_back(v);
+    std::sort(rest.begin(), rest.end(),
+              [](int a, int b) { return bdd_var2level(a) < bdd_var2level(b); });
+    neworder.insert(neworder.end(), rest.begin(), rest.end());
+    bdd_setvarorder(neworder.data());
+}
+
+// ======== KERNEL TELEMETRY ========
+// GC and resize hooks are installed for the duration of one bddReach. The
+// cache counters are cumulative over the kernel's lifetime (a batch shares
+// one kernel), so a snapshot taken at the start is subtracted at the end.
+
+struct TelemetryRecorder {
+    BddTelemetry t;
+    bddCacheStat cacheStart;
+    std::chrono::steady_clock::time_point gcStart;
+    bddgbchandler oldGbc = nullptr;
+    bdd2inthandler oldResize = nullptr;
+};
+
+static TelemetryRecorder* activeTelemetry = nullptr;
+
+static void telemetryGbcHandler(int pre, bddGbcStat* s) {
+    TelemetryRecorder& r = *activeTelemetry;
+    if (pre) {
+        // Just before a GC the table is as full as it gets; after it only the
+        // survivors remain, which would understate the peak.
+        r.t.peakLiveNodes = std::max(r.t.peakLiveNodes, s->nodes - s->freenodes);
+        r.gcStart = std::chrono::steady_clock::now();
+        return;
+    }
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - r.gcStart).count();
+    r.t.gcCount++;
+    r.t.gcTimeSec += sec;
+    LOG_INFO("[BDD] GC #" << s->num << ": " << s->nodes << " nodes / "
+             << s->freenodes << " free / " << sec * 1000 << " ms");
+}
+
+static void telemetryResizeHandler(int oldSize, int newSize) {
+    activeTelemetry->t.resizeCount++;
+    LOG_INFO("[BDD] Node table resized: " << oldSize << " -> " << newSize);
+}
+
+static void telemetryBegin(TelemetryRecorder& r) {
+    activeTelemetry = &r;
+    bdd_cachestats(&r.cacheStart);
+    r.oldGbc = bdd_gbc_hook(telemetryGbcHandler);
+    r.oldResize = bdd_resize_hook(telemetryResizeHandler);
+}
+
+static BddTelemetry telemetryEnd(TelemetryRecorder& r) {
+    bdd_gbc_hook(r.oldGbc);
+    bdd_resize_hook(r.oldResize);
+    activeTelemetry = nullptr;
+
+    r.t.peakLiveNodes = std::max(r.t.peakLiveNodes, bdd_getnodenum());
+
+    bddCacheStat now;
+    bdd_cachestats(&now);
+    for (int k = 0; k < BddTelemetry::CACHE_KINDS && k < BDD_OPCACHENUM; ++k) {
+        unsigned long hits = now.opHitCache[k] - r.cacheStart.opHitCache[k];
+        unsigned long misses = now.opMissCache[k] - r.cacheStart.opMissCache[k];
+        if (hits + misses > 0)
+            r.t.cacheHitRate[k] = (double)hits / (double)(hits + misses);
+    }
+
+    LOG_INFO("[BDD] GC: " << r.t.gcCount << " (" << r.t.gcTimeSec << "s), resizes: "
+             << r.t.resizeCount << ", peak live nodes: " << r.t.peakLiveNodes);
+    Logger::get().flush();
+    return r.t;
+}
+
+// Token counter of place p over its current-state (or next-state) variables
+static bvec placeCounter(int p, int bits, bool next) {
+    std::vector<int> vars(bits);
+    for (int j = 0; j < bits; ++j) vars[j] = currVar(p, j, bits) + (next ? 1 : 0);
+    return bvec_varvecpp(bits, vars.data());
+}
+
+// Relation of one transition over (x, x') for places holding 0..bound
+// tokens. It does not guard against results above bound: the fixpoint
+// checks for such steps afterwards (overflowSet) and discards the result.
+static bdd transitionRelation(const Model& net, size_t t, int bound) {
+    int numPlaces = net.places.size();
+    int bits = bitsForBound(bound);
+    int mask = (1 << bits) - 1;
+    bdd trans_t = bdd_true();
+    for (int p = 0; p < numPlaces; ++p) {
+        int preVal = net.Pre[p][t];
+        int postVal = net.Post[p][t];
+
+        if (bits == 1 && preVal <= 1 && postVal <= 1) {
+            int curr = currVar(p, 0, 1);  // Current state var
+            int next = curr + 1;          // Next state var
 
             // Enable condition: need token if Pre=1
             if (preVal == 1) trans_t &= bdd_ithvar(curr);
@@ -74,36 +401,518 @@ BddResult bddReach(const Model& net, const BddOptions& opts) {
                 trans_t &= bdd_nithvar(next);
             else
                 trans_t &= bdd_apply(bdd_ithvar(curr), bdd_ithvar(next), bddop_biimp);
+            continue;
+        }
+
+        // Weighted arcs: x >= Pre, x' = x - Pre + Post on bits-wide counters.
+        // Below the bound the sum modulo 2^bits is exact.
+        if (preVal > bound) return bdd_false();
+        bvec x = placeCounter(p, bits, false);
+        if (preVal > 0) trans_t &= bvec_gte(x, bvec_conpp(bits, preVal));
+        trans_t &= bvec_equ(placeCounter(p, bits, true),
+                            bvec_add(x, bvec_conpp(bits, (postVal - preVal) & mask)));
+    }
+    return trans_t;
+}
+
+// Markings where t is enabled and firing it would put more than bound
+// tokens in some place
+static bdd overflowSet(const Model& net, size_t t, int bound) {
+    int bits = bitsForBound(bound);
+    int mask = (1 << bits) - 1;
+    bdd enabled = bdd_true();
+    bdd tooMany = bdd_false();
+    for (size_t p = 0; p < net.places.size(); ++p) {
+        int preVal = net.Pre[p][t];
+        int postVal = net.Post[p][t];
+        int room = bound + preVal - postVal;  // Most tokens p may hold before t fires
+        if (preVal > bound) return bdd_false();
+
+        bvec x = placeCounter(p, bits, false);
+        if (preVal > 0) enabled &= bvec_gte(x, bvec_conpp(bits, preVal));
+        if (postVal > preVal && room < 0) tooMany = bdd_true();
+        else if (postVal > preVal && room < mask) tooMany |= bvec_gth(x, bvec_conpp(bits, room));
+    }
+    return enabled & tooMany;
+}
+
+// ======== PARALLEL IMAGE (worker processes) ========
+// BuDDy keeps all of its state in globals, so its operations cannot run on
+// several threads. Workers are fork()ed copies of the kernel instead (TR is
+// shared copy-on-write). Each iteration the frontier is cut into slices along
+// its top variables, and slices are handed out one at a time to whichever
+// worker is idle, in bdd_savebin format over pipes; the parent ORs the
+// returned partial images.
+
+static bdd imageOf(const bdd& frontier, const bdd& TR, const bdd& currentVarSet, bddPair* pairs) {
+    bdd next_prime = bdd_relprod(frontier, TR, currentVarSet);
+    return bdd_replace(next_prime, pairs);  // Rename x' -> x
+}
+
+#ifndef _WIN32
+struct ImageWorker {
+    pid_t pid = -1;
+    FILE* request = nullptr;   // parent -> worker: frontier slice
+    FILE* reply = nullptr;     // worker -> parent: image of the slice
+    bool busy = false;
+};
+
+// Worker side: answer slice requests until the parent closes the pipe
+static void imageWorkerLoop(FILE* in, FILE* out, const bdd& TR,
+                            const bdd& currentVarSet, bddPair* pairs) {
+    // Any error ends the worker; the parent then computes the image itself
+    outerErrHandler = nullptr;
+    bdd_error_hook(recordBddError);
+    while (true) {
+        bdd slice;
+        if (bdd_loadbin(in, slice) != 0) break;
+        bdd image = imageOf(slice, TR, currentVarSet, pairs);
+        if (pendingBddError != 0) break;
+        if (bdd_savebin(out, image) != 0 || fflush(out) != 0) break;
+    }
+}
+
+// Fork up to n workers; returns the ones that could be started
+static std::vector<ImageWorker> startImageWorkers(int n, const bdd& TR,
+                                                  const bdd& currentVarSet, bddPair* pairs) {
+    std::vector<ImageWorker> workers;
+    std::cout.flush();
+    std::cerr.flush();
+    for (int i = 0; i < n; ++i) {
+        int toWorker[2], fromWorker[2];
+        if (pipe(toWorker) != 0) break;
+        if (pipe(fromWorker) != 0) {
+            close(toWorker[0]); close(toWorker[1]);
+            break;
+        }
+        pid_t pid = fork();
+        if (pid < 0) {
+            close(toWorker[0]); close(toWorker[1]);
+            close(fromWorker[0]); close(fromWorker[1]);
+            break;
+        }
+        if (pid == 0) {
+            // Only this worker's pipe ends stay open in the child
+            for (ImageWorker& w : workers) {
+                fclose(w.request);
+                fclose(w.reply);
+            }
+            close(toWorker[1]);
+            close(fromWorker[0]);
+            FILE* in = fdopen(toWorker[0], "rb");
+            FILE* out = fdopen(fromWorker[1], "wb");
+            if (in && out) imageWorkerLoop(in, out, TR, currentVarSet, pairs);
+            _exit(0);
+        }
+        close(toWorker[0]);
+        close(fromWorker[1]);
+        ImageWorker w;
+        w.pid = pid;
+        w.request = fdopen(toWorker[1], "wb");
+        w.reply = fdopen(fromWorker[0], "rb");
+        workers.push_back(w);
+    }
+    return workers;
+}
+
+static void stopImageWorkers(std::vector<ImageWorker>& workers) {
+    for (ImageWorker& w : workers) {
+        if (w.request) fclose(w.request);   // EOF ends the worker loop
+        if (w.reply) fclose(w.reply);
+        int status = 0;
+        waitpid(w.pid, &status, 0);
+    }
+    workers.clear();
+}
+
+// Cut f into at most maxSlices disjoint parts whose union is f. The largest
+// part (by node count) is split on its top variable until enough parts exist.
+static std::vector<bdd> splitFrontier(const bdd& f, size_t maxSlices) {
+    struct Slice { bdd prefix, rest; int size; };
+    std::vector<Slice> slices = {{bdd_true(), f, bdd_nodecount(f)}};
+    while (slices.size() < maxSlices) {
+        size_t big = 0;
+        for (size_t i = 1; i < slices.size(); ++i)
+            if (slices[i].size > slices[big].size) big = i;
+        Slice s = slices[big];
+        if (s.rest == bdd_true() || s.rest == bdd_false()) break;
+
+        int v = bdd_var(s.rest);
+        bdd lo = bdd_low(s.rest), hi = bdd_high(s.rest);
+        slices.erase(slices.begin() + big);
+        if (lo != bdd_false())
+            slices.push_back({s.prefix & bdd_nithvar(v), lo, bdd_nodecount(lo)});
+        if (hi != bdd_false())
+            slices.push_back({s.prefix & bdd_ithvar(v), hi, bdd_nodecount(hi)});
+    }
+    std::vector<bdd> parts;
+    for (const Slice& s : slices) parts.push_back(s.prefix & s.rest);
+    return parts;
+}
+
+// Merging worker results: running out of nodes is recorded for the caller
+// (makeRoom / partial result), load errors are reported by bdd_loadbin's
+// return value and must not reach the outer handler
+static void recordMergeError(int e) {
+    if (e == BDD_NODENUM && pendingBddError == 0) pendingBddError = e;
+}
+
+// Image of the whole frontier computed by the workers. Slices are dispatched
+// as workers become idle. Returns false if any worker failed; running out of
+// nodes while merging returns true with pendingBddError set and image = bddfalse.
+static bool parallelImage(std::vector<ImageWorker>& workers, const bdd& frontier, bdd& image) {
+    std::vector<bdd> slices = splitFrontier(frontier, 4 * workers.size());
+    size_t next = 0, pending = 0;
+    image = bdd_false();
+
+    auto dispatch = [&](ImageWorker& w) {
+        if (next == slices.size()) return true;
+        if (bdd_savebin(w.request, slices[next++]) != 0 || fflush(w.request) != 0) return false;
+        w.busy = true;
+        ++pending;
+        return true;
+    };
+    for (ImageWorker& w : workers)
+        if (!dispatch(w)) return false;
+
+    std::vector<pollfd> fds(workers.size());
+    bool ok = true;
+    bddinthandler oldHandler = bdd_error_hook(recordMergeError);
+    while (ok && pending > 0 && pendingBddError == 0) {
+        for (size_t i = 0; i < workers.size(); ++i)
+            fds[i] = {fileno(workers[i].reply), (short)(workers[i].busy ? POLLIN : 0), 0};
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            ok = (errno == EINTR);
+            continue;
+        }
+        for (size_t i = 0; i < workers.size() && ok && pendingBddError == 0; ++i) {
+            if (!workers[i].busy || !(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            bdd part;
+            ok = bdd_loadbin(workers[i].reply, part) == 0;
+            if (!ok) break;
+            image |= part;
+            workers[i].busy = false;
+            --pending;
+            ok = dispatch(workers[i]);
         }
-        TR |= trans_t;
     }
+    bdd_error_hook(oldHandler);
+    if (pendingBddError != 0) {
+        image = bdd_false();
+        return true;  // The workers are fine; busy ones are stopped by the caller
+    }
+    return ok;
+}
+#endif
+
+// Build TR and iterate Reached = Reached ∪ Image(New) until stable. The
+// states are counted as they are found: each new_diff is disjoint from
+// Reached, so its count adds to reachedCount without recounting Reached.
+// overflowed is set when a reached marking enables a step that would
+// exceed the token bound; the states past it are then not trustworthy.
+// With capped, such steps are left out of TR instead (partial result).
+// A loaded checkpoint replaces M0 as the starting point (used once).
+static bdd computeReachedFixpoint(const Model& net, const BddOptions& opts, int bound,
+                                  bool capped, const bdd& currentVarSet, FixpointCheckpoint& ckpt,
+                                  int& loopCount, double& reachedCount, bool& complete,
+                                  bool& overflowed) {
+    int numPlaces = net.places.size();
+    int bits = bitsForBound(bound);
+    int numPairs = numPlaces * bits;
+    complete = true;
+    overflowed = false;
+
+    // A step that ran out of nodes is retried once after reordering
+    bool reordered = false;
+    auto makeRoom = [&]() {
+        if (reordered) return false;
+        reordered = true;
+        return reorderForSpace(numPairs);
+    };
+
+    // Encode initial marking M0
+    bdd M0_bdd = markingToBdd(net.M0, numPlaces, bits);
+
+    // Build transition relation: TR = OR of all transitions
+    bdd TR = bdd_false();
+
+    // Variable renaming pairs for next->current substitution
+    bddPair* pairs = bdd_newpair();
+    for (int i = 0; i < numPairs; ++i) {
+        // Map biến lẻ (Next - 2i+1) về biến chẵn (Curr - 2i)
+        bdd_setpair(pairs, i * 2 + 1, i * 2);
+    }
+
+    // Encode each transition
+    for (size_t t = 0; t < net.transitions.size(); ++t) {
+        bdd rel = transitionRelation(net, t, bound);
+        if (capped) rel &= !overflowSet(net, t, bound);
+        bdd grownTR = TR | rel;
+        if (pendingBddError != 0) {
+            grownTR = bdd_false();
+            if (makeRoom()) {
+                --t;
+                continue;
+            }
+            clearBddError();
+            LOG_WARN("[BDD] Memory limit reached while building the transition relation");
+            complete = false;
+            loopCount = 0;
+            reachedCount = 1;
+            bdd_freepair(pairs);
+            return M0_bdd;
+        }
+        TR = grownTR;
+    }
+
+#ifndef _WIN32
+    // A dead worker must surface as a write error, not kill this process
+    std::vector<ImageWorker> workers;
+    void (*oldPipeHandler)(int) = SIG_DFL;
+    if (opts.workers > 1) {
+        oldPipeHandler = signal(SIGPIPE, SIG_IGN);
+        workers = startImageWorkers(opts.workers, TR, currentVarSet, pairs);
+        if ((int)workers.size() < opts.workers)
+            std::cerr << "[BDD] Warning: started " << workers.size() << "/" << opts.workers
+                      << " image workers" << std::endl;
+    }
+#endif
 
     // Fixpoint computation: Reached = Reached ∪ Image(New) until stable
     bdd Reached = M0_bdd;
     bdd New = M0_bdd;
-    bdd currentVarSet = bdd_true();
-    for (int i = 0; i < numPlaces; ++i)
-        currentVarSet &= bdd_ithvar(i * 2);
+    reachedCount = 1;
+
+    loopCount = 0;
+    if (ckpt.resumed) {
+        Reached = ckpt.reached;
+        New = ckpt.frontier;
+        loopCount = ckpt.iters;
+        reachedCount = ckpt.count;
+        ckpt.resumed = false;
+        ckpt.reached = ckpt.frontier = bdd_false();
+        LOG_INFO("[BDD] Resumed at iteration " << loopCount << ": " << reachedCount << " states");
+    }
+    double lastSave = getTimeSec();
+    bool converged = false;
 
-    int loopCount = 0;
     while (true) {
-        if (++loopCount > opts.maxIters) break;
+        if (++loopCount > opts.maxIters) {
+            LOG_WARN("[BDD] Stopped after " << opts.maxIters
+                     << " iterations, returning the states found so far");
+            complete = false;
+            break;
+        }
 
         // Image computation: ∃x. (New(x) ∧ TR(x,x'))
-        bdd next_prime = bdd_relprod(New, TR, currentVarSet);
-        bdd next_state = bdd_replace(next_prime, pairs);  // Rename x' -> x
+        bdd next_state;
+#ifndef _WIN32
+        if (!workers.empty() && !parallelImage(workers, New, next_state)) {
+            std::cerr << "[BDD] Warning: image worker failed, "
+                      << "computing the image in-process" << std::endl;
+            stopImageWorkers(workers);
+        }
+        if (workers.empty())
+#endif
+            next_state = imageOf(New, TR, currentVarSet, pairs);
         bdd new_diff = next_state - Reached;
+        bdd grown = Reached | new_diff;
 
-        if (new_diff == bdd_false()) break;  // Fixpoint reached
+        // Out of nodes: results of this step are bddfalse, not the real sets
+        if (pendingBddError != 0) {
+            next_state = new_diff = grown = bdd_false();
+#ifndef _WIN32
+            stopImageWorkers(workers);  // their copies would keep the old order
+#endif
+            if (makeRoom()) {
+                --loopCount;
+                continue;
+            }
+            clearBddError();
+            LOG_WARN("[BDD] Memory limit reached after " << loopCount - 1
+                     << " iterations, returning the states found so far");
+            complete = false;
+            break;
+        }
 
-        Reached |= new_diff;
+        if (new_diff == bdd_false()) {  // Fixpoint reached
+            converged = true;
+            break;
+        }
+
+        Reached = grown;
         New = new_diff;
+        reachedCount += bdd_satcountset(new_diff, currentVarSet);
+        LOG_DEBUG("[BDD] Iteration " << loopCount << ": " << reachedCount << " states");
+        if (!ckpt.path.empty() && getTimeSec() - lastSave >= ckpt.intervalSec) {
+            saveCheckpoint(ckpt, 2 * numPairs, bound, capped, Reached, New, loopCount, reachedCount);
+            lastSave = getTimeSec();
+        }
+    }
+    // Every exit leaves loopCount one past the last finished iteration
+    if (!ckpt.path.empty() && converged) remove(ckpt.path.c_str());
+    else if (!ckpt.path.empty())
+        saveCheckpoint(ckpt, 2 * numPairs, bound, capped, Reached, New, loopCount - 1, reachedCount);
+
+    // Checked once on the final Reached, not per frontier: it is rare, and
+    // the whole result is thrown away when it happens
+    for (size_t t = 0; !capped && complete && !overflowed && t < net.transitions.size(); ++t) {
+        overflowed = (Reached & overflowSet(net, t, bound)) != bdd_false();
+        if (pendingBddError != 0) {
+            clearBddError();
+            overflowed = false;
+            complete = false;
+        }
+    }
+
+#ifndef _WIN32
+    stopImageWorkers(workers);
+    if (opts.workers > 1) signal(SIGPIPE, oldPipeHandler);
+#endif
+    bdd_freepair(pairs);
+    return Reached;
+}
+
+// Main symbolic reachability algorithm
+BddResult bddReach(const Model& net, const BddOptions& opts) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    BddResult res;
+    int numPlaces = net.places.size();
+    res.tokenBound = opts.tokenBound > 0 ? std::min(opts.tokenBound, MAX_TOKENS)
+                                         : initialTokenBound(net);
+    // Current (even) + Next (odd) vars for every bit of every place
+    auto varsFor = [numPlaces](int bound) { return 2 * numPlaces * bitsForBound(bound); };
+    int numVars = varsFor(res.tokenBound);
+
+    // Initialize BuDDy; a running kernel (batch mode) is reused and only
+    // grows its variable count when this model needs more. Growth policy
+    // and cache ratio are retuned for every model.
+    res.kernel = tuneBddKernel(net, res.tokenBound,
+                               opts.memBudgetMB > 0 ? opts.memBudgetMB : opts.memLimitMB);
+    if (!bdd_isrunning()) {
+        bdd_init(res.kernel.nodes, res.kernel.cacheSize);
+        bdd_setvarnum(numVars);
+    } else {
+        if (bdd_varnum() < numVars)
+            bdd_extvarnum(numVars - bdd_varnum());
+        res.kernel.nodes = bdd_getallocnum();
+        res.kernel.cacheSize = res.kernel.nodes / res.kernel.cacheRatio;
+    }
+    bdd_setcacheratio(res.kernel.cacheRatio);
+    bdd_setmaxincrease(res.kernel.maxIncrease);
+    bdd_setminfreenodes(res.kernel.minFreePct);
+
+    // Hard cap on the node table (0 lifts a cap left by an earlier batch model)
+    int maxNodes = 0;
+    if (opts.memLimitMB > 0)
+        maxNodes = (int)std::min(opts.memLimitMB * 1024.0 * 1024.0 / bytesPerNode(res.kernel.cacheRatio),
+                                 2147483647.0);
+    if (maxNodes > 0 && maxNodes <= bdd_getallocnum()) {
+        LOG_WARN("[BDD] Warning: node table already holds " << bdd_getallocnum()
+                 << " nodes, over the memory limit");
+        maxNodes = bdd_getallocnum() + 1;
+    }
+    bdd_setmaxnodenum(maxNodes);
+    pendingBddError = 0;
+    outerErrHandler = bdd_error_hook(recordBddError);
+    LOG_INFO("[BDD] Kernel: " << res.kernel.nodes << " nodes, cache " << res.kernel.cacheSize
+             << " (ratio " << res.kernel.cacheRatio << "), max increase "
+             << res.kernel.maxIncrease << ", min free " << res.kernel.minFreePct << "%");
+
+    TelemetryRecorder telemetry;
+    telemetryBegin(telemetry);
+
+    // Reuse a previously computed Reached for an identical model (and, with
+    // a fixed bound, the same encoding)
+    if (opts.placeOrder.size() == (size_t)numPlaces)
+        applyPlaceOrder(opts.placeOrder, bitsForBound(res.tokenBound));
+
+    bdd Reached;
+    int loopCount = 0;
+    std::string cachePath;
+    uint64_t cacheKey = 0;
+    if (!opts.cacheDir.empty()) {
+        cacheKey = modelHash(net);
+        cachePath = reachCachePath(opts.cacheDir, cacheKey);
+        int cachedBound = opts.tokenBound > 0 ? res.tokenBound : 0;
+        res.fromCache = loadReachedCache(cachePath, cacheKey, numPlaces, cachedBound,
+                                         Reached, loopCount);
+        if (res.fromCache) res.tokenBound = cachedBound;
     }
 
+    auto currentVars = [numPlaces](int bound) {
+        bdd vars = bdd_true();
+        for (int i = 0; i < numPlaces * bitsForBound(bound); ++i)
+            vars &= bdd_ithvar(i * 2);
+        return vars;
+    };
+    bdd currentVarSet = currentVars(res.tokenBound);
+
+    double reachedCount = 0;
+    if (!res.fromCache) {
+        // Without a fixed bound, a net that outgrows k is redone with 2k+1
+        // (one more bit per place) until it fits or k reaches MAX_TOKENS
+        bool capped = false;
+
+        // A checkpoint fixes the bound (and capping) it was taken with
+        FixpointCheckpoint ckpt;
+        if (!opts.checkpointDir.empty()) {
+            ckpt.key = modelHash(net);
+            ckpt.path = checkpointPath(opts.checkpointDir, ckpt.key);
+            ckpt.intervalSec = opts.checkpointSec;
+            int savedBound = opts.tokenBound > 0 ? res.tokenBound : 0;
+            if (opts.resume && loadCheckpoint(ckpt, numPlaces, savedBound, capped)
+                && savedBound != res.tokenBound) {
+                res.tokenBound = savedBound;
+                numVars = varsFor(res.tokenBound);
+                if (opts.placeOrder.size() == (size_t)numPlaces)
+                    applyPlaceOrder(opts.placeOrder, bitsForBound(res.tokenBound));
+                currentVarSet = currentVars(res.tokenBound);
+            }
+        }
+
+        while (true) {
+            bool overflowed = false;
+            Reached = bdd_false();
+            Reached = computeReachedFixpoint(net, opts, res.tokenBound, capped, currentVarSet, ckpt,
+                                             loopCount, reachedCount, res.complete, overflowed);
+            if (capped) {
+                res.complete = false;
+                break;
+            }
+            if (!overflowed) break;
+            if (opts.tokenBound > 0 || res.tokenBound >= MAX_TOKENS) {
+                // Redo without the steps past the bound: the states kept are all reachable
+                LOG_WARN("[BDD] A place exceeds " << res.tokenBound
+                         << " tokens, returning the states within the bound");
+                capped = true;
+                continue;
+            }
+            res.tokenBound = std::min(2 * res.tokenBound + 1, MAX_TOKENS);
+            LOG_INFO("[BDD] A place exceeds the token bound, retrying with k = " << res.tokenBound);
+            numVars = varsFor(res.tokenBound);
+            if (bdd_varnum() < numVars)
+                bdd_extvarnum(numVars - bdd_varnum());
+            if (opts.placeOrder.size() == (size_t)numPlaces)
+                applyPlaceOrder(opts.placeOrder, bitsForBound(res.tokenBound));
+            currentVarSet = currentVars(res.tokenBound);
+        }
+        if (!cachePath.empty() && res.complete)
+            saveReachedCache(cachePath, cacheKey, numVars, res.tokenBound, Reached, loopCount);
+    } else {
+        reachedCount = bdd_satcountset(Reached, currentVarSet);
+    }
+    if (res.tokenBound > 1)
+        LOG_INFO("[BDD] Token bound k = " << res.tokenBound << " ("
+                 << bitsForBound(res.tokenBound) << " bits per place)");
+
     // Collect results
-    res.states = (size_t)bdd_satcountset(Reached, currentVarSet);
+    res.states = (size_t)reachedCount;
     res.nodeCount = bdd_getnodenum();
     res.iters = loopCount;
+    res.telemetry = telemetryEnd(telemetry);
+    bdd_error_hook(outerErrHandler);
     res.timeSec = std::chrono::duration<double>(
         std::chrono::high_resolution_clock::now() - start_time).count();
 
@@ -112,21 +921,80 @@ BddResult bddReach(const Model& net, const BddOptions& opts) {
     bdd_addref(reachedID);
     res.internalState = new int(reachedID);
 
-    bdd_freepair(pairs);
     return res;
 }
 
-// Check if marking M is in the Reached set (M ∧ Reached ≠ false)
+// ======== MEMBERSHIP ========
+// Reached only depends on the current-state variables and a marking assigns
+// all of them, so a membership test is one path from the root: the high
+// edge where the variable's bit of the place's token count is 1, the low
+// edge otherwise. Levels the path skips are don't-cares. No node is built
+// and no cache is touched, unlike intersecting with markingToBdd(M).
+
+// 1 if the token-count bit encoded by current-state variable var is set in M
+static int markingBit(const Marking& M, int var, int bits) {
+    int pair = var / 2;
+    return (M[pair / bits] >> (pair % bits)) & 1;
+}
+
+// Counts above the bound have no encoding; their low bits must not be walked
+static bool withinBound(const Marking& M, int numPlaces, int bound) {
+    for (int p = 0; p < numPlaces; ++p)
+        if (M[p] > bound) return false;
+    return true;
+}
+
+static bool reachedContains(BDD node, const Marking& M, int bits) {
+    while (node > 1)
+        node = markingBit(M, bdd_var(node), bits) ? bdd_high(node) : bdd_low(node);
+    return node == 1;
+}
+
+// Check if marking M is in the Reached set
 bool bdd_check_reachable(const BddResult& bddResult, const Marking& M, int numPlaces) {
     if (!bddResult.internalState || !bdd_isrunning()) return false;
-    
-    BDD ReachedBDD = *static_cast<int*>(bddResult.internalState);
-    BDD markingBDD = markingToBdd(M, numPlaces).id();
-    BDD resultBDD = bdd_addref(bdd_and(markingBDD, ReachedBDD));
-    
-    bool isReachable = (resultBDD != 0);
-    bdd_delref(resultBDD);
-    return isReachable;
+    if ((int)M.size() < numPlaces) return false;
+    if (!withinBound(M, numPlaces, bddResult.tokenBound)) return false;
+
+    return reachedContains(*static_cast<int*>(bddResult.internalState), M,
+                           bitsForBound(bddResult.tokenBound));
+}
+
+// Batch version: markings that share a path prefix share its node visits.
+// The markings are partitioned by the bit each node tests, so every group
+// descends the BDD once.
+std::vector<bool> bdd_check_reachable_batch(const BddResult& bddResult,
+                                            const std::vector<Marking>& Ms, int numPlaces) {
+    std::vector<bool> hits(Ms.size(), false);
+    if (!bddResult.internalState || !bdd_isrunning()) return hits;
+
+    std::vector<size_t> order;
+    order.reserve(Ms.size());
+    for (size_t k = 0; k < Ms.size(); ++k)
+        if ((int)Ms[k].size() >= numPlaces && withinBound(Ms[k], numPlaces, bddResult.tokenBound))
+            order.push_back(k);
+
+    int bits = bitsForBound(bddResult.tokenBound);
+    struct Group { BDD node; size_t begin, end; };
+    std::vector<Group> work;
+    work.push_back({*static_cast<int*>(bddResult.internalState), 0, order.size()});
+    while (!work.empty()) {
+        Group g = work.back();
+        work.pop_back();
+        if (g.begin == g.end || g.node == 0) continue;
+        if (g.node == 1) {
+            for (size_t i = g.begin; i < g.end; ++i) hits[order[i]] = true;
+            continue;
+        }
+
+        int var = bdd_var(g.node);
+        size_t mid = std::partition(order.begin() + g.begin, order.begin() + g.end,
+                                    [&](size_t k) { return markingBit(Ms[k], var, bits) == 0; })
+                     - order.begin();
+        work.push_back({bdd_low(g.node), g.begin, mid});
+        work.push_back({bdd_high(g.node), mid, g.end});
+    }
+    return hits;
 }
 
 // Free BDD resources
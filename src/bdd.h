@@ -11,14 +11,32 @@
 struct BddOptions {
     int maxIters = 1000;
     bool useGC = true;
+    std::string cacheDir;  // If set, Reached is persisted here keyed by modelHash()
+    int workers = 1;       // >1 (experimental): image slices computed by forked worker processes (POSIX only);
+                           // the parent merges them serially, no speedup measured
+    double memBudgetMB = 0;  // >0: initial node table + caches are sized to fit this budget
+    double memLimitMB = 0;   // >0: hard cap on node table + caches; a full table ends in a partial result
+    int tokenBound = 0;      // k: places hold 0..k tokens; 0 = from initialTokenBound, widened on overflow
+    std::vector<int> placeOrder;  // Places from the top of the variable order down (empty: kernel's order)
+    std::string checkpointDir;    // If set, Reached/New/iteration are saved here during the fixpoint
+    double checkpointSec = 300;   // Seconds between checkpoints; a partial result always saves one
+    bool resume = false;          // Continue from the checkpoint in checkpointDir (same model)
 };
 
+// Derive BuDDy node-table / cache parameters from the net size, the token bound
+// of the encoding and an optional budget (MB, 0 = none)
+BddKernelParams tuneBddKernel(const Model& net, int tokenBound, double memBudgetMB);
+
 // Compute reachable states using BDD fixpoint
 BddResult bddReach(const Model& net, const BddOptions& opts);
 
 // Check if marking M is in the reachable set (used by ILP)
 bool bdd_check_reachable(const BddResult& bddResult, const Marking& M, int numPlaces);
 
+// Check many markings at once; bit k of the result is set iff Ms[k] is reachable
+std::vector<bool> bdd_check_reachable_batch(const BddResult& bddResult,
+                                            const std::vector<Marking>& Ms, int numPlaces);
+
 // Free BDD resources
 void bdd_cleanup(BddResult& bddResult);
 
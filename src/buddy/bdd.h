@@ -63,6 +63,18 @@
 #define bddop_simplify 11
 
 
+/*=== Operator caches (index of the per-cache counters) ================*/
+
+#define bddcache_apply   0
+#define bddcache_ite     1
+#define bddcache_quant   2
+#define bddcache_appex   3
+#define bddcache_replace 4
+#define bddcache_misc    5
+
+#define BDD_OPCACHENUM   6
+
+
 /*=== User BDD types ===================================================*/
 
 typedef int BDD;
@@ -168,6 +180,8 @@ PROTO   {* typedef struct s_bddCacheStat
    long unsigned int opHit;
    long unsigned int opMiss;
    long unsigned int swapCount;
+   long unsigned int opHitCache[BDD_OPCACHENUM];
+   long unsigned int opMissCache[BDD_OPCACHENUM];
 } bddCacheStat; *}
 DESCR   {* The fields are \\[\baselineskip] \begin{tabular}{ll}
   {\bf Name}         & {\bf Number of } \\
@@ -178,7 +192,11 @@ DESCR   {* The fields are \\[\baselineskip] \begin{tabular}{ll}
   opHit        & entries found in the operator caches \\
   opMiss       & entries not found in the operator caches \\
   swapCount    & number of variable swaps in reordering \\
-\end{tabular} *}
+  opHitCache   & opHit split by cache ({\tt bddcache\_apply} \ldots {\tt bddcache\_misc}) \\
+  opMissCache  & opMiss split by cache \\
+\end{tabular}
+           The operator counters are only updated when BuDDy is built
+           with {\tt CACHESTATS}. *}
 ALSO    {* bdd\_cachestats *}
 */
 typedef struct s_bddCacheStat
@@ -190,6 +208,8 @@ typedef struct s_bddCacheStat
    long unsigned int opHit;
    long unsigned int opMiss;
    long unsigned int swapCount;
+   long unsigned int opHitCache[BDD_OPCACHENUM];
+   long unsigned int opMissCache[BDD_OPCACHENUM];
 } bddCacheStat;
 
 /*=== BDD interface prototypes =========================================*/
@@ -326,6 +346,10 @@ extern int      bdd_fnsave(char *, BDD);
 extern int      bdd_save(FILE *, BDD);
 extern int      bdd_fnload(char *, BDD *);
 extern int      bdd_load(FILE *ifile, BDD *);
+extern int      bdd_fnsavebin(char *, BDD);
+extern int      bdd_savebin(FILE *, BDD);
+extern int      bdd_fnloadbin(char *, BDD *);
+extern int      bdd_loadbin(FILE *ifile, BDD *);
 
 /* In file reorder.c */
 
@@ -519,6 +543,10 @@ private:
    friend int    bdd_save(FILE*, const bdd &);
    friend int    bdd_fnload(char*, bdd &);
    friend int    bdd_load(FILE*, bdd &);
+   friend int    bdd_fnsavebin(char*, const bdd &);
+   friend int    bdd_savebin(FILE*, const bdd &);
+   friend int    bdd_fnloadbin(char*, bdd &);
+   friend int    bdd_loadbin(FILE*, bdd &);
    
    friend bdd    fdd_ithvarpp(int, int);
    friend bdd    fdd_ithsetpp(int);
@@ -724,6 +752,18 @@ inline int bdd_fnload(char *fname, bdd &r)
 inline int bdd_load(FILE *ifile, bdd &r)
 { int lr,e; e=bdd_load(ifile, &lr); r=bdd(lr); return e; }
 
+inline int bdd_fnsavebin(char *fname, const bdd &r)
+{ return bdd_fnsavebin(fname, r.root); }
+
+inline int bdd_savebin(FILE *ofile, const bdd &r)
+{ return bdd_savebin(ofile, r.root); }
+
+inline int bdd_fnloadbin(char *fname, bdd &r)
+{ int lr,e; e=bdd_fnloadbin(fname, &lr); r=bdd(lr); return e; }
+
+inline int bdd_loadbin(FILE *ifile, bdd &r)
+{ int lr,e; e=bdd_loadbin(ifile, &lr); r=bdd(lr); return e; }
+
 inline int bdd_addvarblock(const bdd &v, int f)
 { return bdd_addvarblock(v.root, f); }
 
@@ -47,6 +47,9 @@ static int  bdd_save_rec(FILE*, int);
 static int  bdd_loaddata(FILE *);
 static int  loadhash_get(int);
 static void loadhash_add(int, int);
+static int *bdd_savebin_collect(int, int *);
+static void putvarint(FILE *, unsigned int);
+static int  getvarint(FILE *, unsigned int *);
 
 static bddfilehandler filehandler;
 
@@ -590,4 +593,372 @@ static int loadhash_get(int key)
 }
 
 
+/*=== BINARY SAVE/LOAD =================================================*/
+
+#define BINMAGIC   "BDDB"
+#define BINVERSION 1
+
+/*
+NAME    {* bdd\_savebin *}
+EXTRA   {* bdd\_fnsavebin *}
+SECTION {* fileio *}
+SHORT   {* saves a BDD to a file in compact binary form *}
+PROTO   {* int bdd_fnsavebin(char *fname, BDD r)
+int bdd_savebin(FILE *ofile, BDD r) *}
+DESCR   {* Binary counterpart of {\tt bdd\_save}. The file {\tt ofile}
+           must be opened for writing in binary mode. All integers are
+	   written as unsigned LEB128 varints:
+
+	   The magic {\tt BDDB}, the format version, the number of
+	   variables $V$ and the variable ordering ($V$ levels), the number
+	   of nodes $N$ and, if $N$ is zero, the constant root. Otherwise
+	   the nodes follow grouped by level, deepest level first: each
+	   group is the variable number, the node count and for every node
+	   its low and high child. Nodes are numbered from $2$ in the order
+	   written; a child is written as $0$ or $1$ for the constants and
+	   as $i-c+1$ otherwise, where $i$ is the number of the node and
+	   $c$ that of the child. The root is the last node. *}
+ALSO    {* bdd\_loadbin, bdd\_save *}
+RETURN  {* Zero on succes, otherwise an error code from {\tt bdd.h}. *}
+*/
+int bdd_fnsavebin(char *fname, BDD r)
+{
+   FILE *ofile;
+   int ok;
+
+   if ((ofile=fopen(fname,"wb")) == NULL)
+      return bdd_error(BDD_FILE);
+
+   ok = bdd_savebin(ofile, r);
+   if (fclose(ofile) != 0  &&  ok == 0)
+      ok = bdd_error(BDD_FILE);
+   return ok;
+}
+
+
+int bdd_savebin(FILE *ofile, BDD r)
+{
+   int *nodes, *sorted, *levelpos;
+   int num=0, i, level;
+
+   CHECK(r);
+   
+   fwrite(BINMAGIC, 1, 4, ofile);
+   putvarint(ofile, BINVERSION);
+   putvarint(ofile, bddvarnum);
+   for (i=0 ; i<bddvarnum ; i++)
+      putvarint(ofile, bddvar2level[i]);
+
+   if (r < 2)
+   {
+      putvarint(ofile, 0);
+      putvarint(ofile, r);
+      return ferror(ofile) ? bdd_error(BDD_FILE) : 0;
+   }
+
+      /* Collect the nodes, then bucket them by level, deepest level first */
+   if ((nodes=bdd_savebin_collect(r, &num)) == NULL)
+      return bdd_error(BDD_MEMORY);
+
+   sorted = (int*)malloc(sizeof(int)*num);
+   levelpos = (int*)calloc(bddvarnum+1, sizeof(int));
+   lh_nodenum = num;
+   lh_table = (LoadHash*)malloc(sizeof(LoadHash)*num);
+   if (sorted == NULL || levelpos == NULL || lh_table == NULL)
+   {
+      free(nodes); free(sorted); free(levelpos); free(lh_table);
+      return bdd_error(BDD_MEMORY);
+   }
+
+   for (i=0 ; i<num ; i++)
+      levelpos[bddvarnum-1-LEVEL(nodes[i])+1]++;
+   for (i=1 ; i<=bddvarnum ; i++)
+      levelpos[i] += levelpos[i-1];
+   for (i=0 ; i<num ; i++)
+      sorted[levelpos[bddvarnum-1-LEVEL(nodes[i])]++] = nodes[i];
+
+      /* File numbers by node, in a table sized by the BDD (not the node table) */
+   for (i=0 ; i<num ; i++)
+   {
+      lh_table[i].first = -1;
+      lh_table[i].next = i+1;
+   }
+   lh_table[num-1].next = -1;
+   lh_freepos = 0;
+   for (i=0 ; i<num ; i++)
+      loadhash_add(sorted[i], i+2);
+
+   putvarint(ofile, num);
+
+      /* Stream one group per level */
+   for (i=0 ; i<num ; )
+   {
+      int start = i;
+      level = LEVEL(sorted[i]);
+      while (i < num  &&  LEVEL(sorted[i]) == level)
+	 i++;
+
+      putvarint(ofile, bddlevel2var[level]);
+      putvarint(ofile, i-start);
+      
+      for ( ; start<i ; start++)
+      {
+	 int node = sorted[start];
+	 int self = start+2;
+	 int lo = LOW(node), hi = HIGH(node);
+	 putvarint(ofile, lo < 2 ? lo : self - loadhash_get(lo) + 1);
+	 putvarint(ofile, hi < 2 ? hi : self - loadhash_get(hi) + 1);
+      }
+   }
+
+   free(nodes);
+   free(sorted);
+   free(levelpos);
+   free(lh_table);
+   lh_table = NULL;
+   
+   return ferror(ofile) ? bdd_error(BDD_FILE) : 0;
+}
+
+
+   /* The distinct inner nodes of r, collected with an explicit stack (a
+      BDD may be as deep as there are variables) and unmarked again.
+      Returns NULL when out of memory. */
+static int *bdd_savebin_collect(int r, int *num)
+{
+   int size = 1024, top = 0, i;
+   int *nodes = (int*)malloc(sizeof(int)*size);
+   int *stack = (int*)malloc(sizeof(int)*size);
+
+   *num = 0;
+   if (nodes == NULL || stack == NULL)
+   {
+      free(nodes); free(stack);
+      return NULL;
+   }
+   
+   SETMARK(r);
+   stack[top++] = r;
+   while (top > 0)
+   {
+      int n = stack[--top];
+      int child[2];
+
+	 /* Every node is on the stack or in nodes, never both */
+      if (*num + top + 2 > size)
+      {
+	 int *bigger = (int*)realloc(nodes, sizeof(int)*size*2);
+	 int *deeper = bigger ? (int*)realloc(stack, sizeof(int)*size*2) : NULL;
+	 if (bigger) nodes = bigger;
+	 if (deeper) stack = deeper;
+	 if (bigger == NULL || deeper == NULL)
+	 {
+	    for (i=0 ; i<*num ; i++) UNMARK(nodes[i]);
+	    for (i=0 ; i<top ; i++) UNMARK(stack[i]);
+	    UNMARK(n);
+	    free(nodes); free(stack);
+	    return NULL;
+	 }
+	 size *= 2;
+      }
+      
+      nodes[(*num)++] = n;
+      child[0] = LOW(n);
+      child[1] = HIGH(n);
+      for (i=0 ; i<2 ; i++)
+	 if (child[i] >= 2  &&  !MARKED(child[i]))
+	 {
+	    SETMARK(child[i]);
+	    stack[top++] = child[i];
+	 }
+   }
+
+   for (i=0 ; i<*num ; i++)
+      UNMARK(nodes[i]);
+   free(stack);
+   return nodes;
+}
+
+
+/*
+NAME    {* bdd\_loadbin *}
+EXTRA   {* bdd\_fnloadbin *}
+SECTION {* fileio *}
+SHORT   {* loads a BDD saved by bdd\_savebin *}
+PROTO   {* int bdd_fnloadbin(char *fname, BDD *r)
+int bdd_loadbin(FILE *ifile, BDD *r) *}
+DESCR   {* Loads a BDD written by {\tt bdd\_savebin} into {\tt r}. Children
+           are resolved through a dense array indexed by file position, so
+	   no load hash is needed. When the current variable ordering equals
+	   the saved one, nodes are inserted directly with
+	   {\tt bdd\_makenode}; otherwise each node is rebuilt with
+	   {\tt bdd\_ite} as {\tt bdd\_load} does. *}
+ALSO    {* bdd\_savebin, bdd\_load *}
+RETURN  {* Zero on succes, otherwise an error code from {\tt bdd.h}. *}
+*/
+int bdd_fnloadbin(char *fname, BDD *root)
+{
+   FILE *ifile;
+   int ok;
+
+   if ((ifile=fopen(fname,"rb")) == NULL)
+      return bdd_error(BDD_FILE);
+
+   ok = bdd_loadbin(ifile, root);
+   fclose(ifile);
+   return ok;
+}
+
+
+int bdd_loadbin(FILE *ifile, BDD *root)
+{
+   char magic[4];
+   unsigned int version, vnum, num, var, count, lo, hi, tmp;
+   unsigned int n, pos;
+   int *savedlevel, *loaded;
+   int sameorder = 1, err = 0;
+
+   *root = 0;
+   
+   if (fread(magic, 1, 4, ifile) != 4  ||  memcmp(magic, BINMAGIC, 4) != 0)
+      return bdd_error(BDD_FORMAT);
+   if (!getvarint(ifile, &version)  ||  version != BINVERSION)
+      return bdd_error(BDD_FORMAT);
+   if (!getvarint(ifile, &vnum)  ||  vnum > MAXVAR)
+      return bdd_error(BDD_FORMAT);
+
+   if ((savedlevel=(int*)malloc(sizeof(int)*(vnum+1))) == NULL)
+      return bdd_error(BDD_MEMORY);
+   for (n=0 ; n<vnum ; n++)
+   {
+      if (!getvarint(ifile, &tmp))
+      {
+	 free(savedlevel);
+	 return bdd_error(BDD_FORMAT);
+      }
+      savedlevel[n] = tmp;
+   }
+
+   if (!getvarint(ifile, &num))
+   {
+      free(savedlevel);
+      return bdd_error(BDD_FORMAT);
+   }
+
+      /* Check for constant true / false */
+   if (num == 0)
+   {
+      free(savedlevel);
+      if (!getvarint(ifile, &tmp)  ||  tmp > 1)
+	 return bdd_error(BDD_FORMAT);
+      *root = tmp;
+      return 0;
+   }
+   
+   if ((int)vnum > bddvarnum)
+      bdd_setvarnum(vnum);
+   for (n=0 ; n<vnum ; n++)
+      if (savedlevel[n] != bddvar2level[n])
+	 sameorder = 0;
+   free(savedlevel);
+
+   if ((loaded=(int*)malloc(sizeof(int)*(num+2))) == NULL)
+      return bdd_error(BDD_MEMORY);
+   loaded[0] = 0;
+   loaded[1] = 1;
+
+      /* makenode must not trigger a reordering in the middle of the load */
+   bdd_disable_reorder();
+   
+   for (pos=2 ; pos<num+2  &&  err == 0 ; )
+   {
+      if (!getvarint(ifile, &var)  ||  !getvarint(ifile, &count)  ||
+	  var >= vnum  ||  count == 0  ||  count > num+2-pos)
+      {
+	 err = BDD_FORMAT;
+	 break;
+      }
+
+      for ( ; count > 0 ; count--, pos++)
+      {
+	 int level = bddvar2level[var];
+	 int low, high, res;
+	 
+	 if (!getvarint(ifile, &lo)  ||  !getvarint(ifile, &hi)  ||
+	     lo >= pos  ||  hi >= pos)
+	 {
+	    err = BDD_FORMAT;
+	    break;
+	 }
+	 low = lo < 2 ? (int)lo : loaded[pos-lo+1];
+	 high = hi < 2 ? (int)hi : loaded[pos-hi+1];
+
+	 if (sameorder)
+	 {
+	    if (low == high  ||
+		(low >= 2  &&  LEVEL(low) <= level)  ||
+		(high >= 2  &&  LEVEL(high) <= level))
+	    {
+	       err = BDD_FORMAT;
+	       break;
+	    }
+	    res = bdd_makenode(level, low, high);
+	    if (res < 2)
+	    {
+	       err = BDD_NODENUM;
+	       break;
+	    }
+	 }
+	 else if ((res=bdd_ite(bdd_ithvar(var), high, low)) < 0)
+	 {
+	    err = res;
+	    break;
+	 }
+
+	 loaded[pos] = bdd_addref(res);
+      }
+   }
+
+   bdd_enable_reorder();
+
+   if (err == 0)
+      *root = loaded[num+1];
+   for (n=2 ; n<pos ; n++)
+      bdd_delref(loaded[n]);
+   free(loaded);
+
+   return err == 0 ? 0 : bdd_error(err);
+}
+
+
+static void putvarint(FILE *ofile, unsigned int v)
+{
+   while (v >= 0x80)
+   {
+      putc((int)((v & 0x7F) | 0x80), ofile);
+      v >>= 7;
+   }
+   putc((int)v, ofile);
+}
+
+
+static int getvarint(FILE *ifile, unsigned int *v)
+{
+   unsigned int res = 0;
+   int shift = 0, c;
+
+   do
+   {
+      if ((c=getc(ifile)) == EOF  ||  shift > 28)
+	 return 0;
+      res |= (unsigned int)(c & 0x7F) << shift;
+      shift += 7;
+   }
+   while (c & 0x80);
+
+   *v = res;
+   return 1;
+}
+
+
 /* EOF */
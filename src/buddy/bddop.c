@@ -109,6 +109,10 @@ static BddCache replacecache;       /* Cache for replace results */
 static BddCache misccache;          /* Cache for other results */
 static int cacheratio;
 static BDD satPolarity;
+static double* satmemo;             /* Per node satcount, -1 when unset */
+static int* satmemoset;             /* Nodes set in satmemo by this call */
+static int satmemotop;              /* Number of entries in satmemoset */
+static int satmemosize;             /* Number of entries in satmemo */
 static int firstReorder;            /* Used instead of local variable in order
 				       to avoid compiler warning about 'first'
 				       being clobbered by setjmp */
@@ -118,6 +122,39 @@ static bddallsathandler allsatHandler; /* Callback handler for bdd_allsat() */
 
 extern bddCacheStat bddcachestats;
 
+#ifdef CACHESTATS
+   /* Count a hit/miss in operator cache c, in total and per cache */
+#define CACHEHIT(c)  (bddcachestats.opHit++, bddcachestats.opHitCache[c]++)
+#define CACHEMISS(c) (bddcachestats.opMiss++, bddcachestats.opMissCache[c]++)
+#endif
+
+#ifdef BDD_NONRECURSIVE
+   /* Explicit stack used instead of the C stack by the iterative operators.
+      The levels of the operands strictly increase from a frame to the next,
+      so one operator never has more than bddvarnum frames, and at most three
+      operators are nested (appquant -> quant -> apply) */
+typedef struct s_BddFrame
+{
+   int a, b;                /* Operands */
+   int state;               /* Number of branches started */
+   BddCacheData *entry;     /* Cache entry to fill in with the result */
+   double dres;             /* Partial result (satcount) */
+} BddFrame;
+
+static BddFrame *opstack;           /* The frames */
+static int opstacktop;              /* First free frame */
+
+   /* Unwinding by longjmp() leaves frames behind, so every operator that
+      resets the reference stack resets the frame stack too */
+#undef  INITREF
+#define INITREF    (bddrefstacktop = bddrefstack, opstacktop = 0)
+
+#define OPPUSH(x,y,e) \
+   (opstack[opstacktop].a = (x), opstack[opstacktop].b = (y), \
+    opstack[opstacktop].state = 0, opstack[opstacktop].entry = (e), \
+    opstack[opstacktop].dres = 0.0, opstacktop++)
+#endif
+
    /* Internal prototypes */
 static BDD    not_rec(BDD);
 static BDD    apply_rec(BDD, BDD);
@@ -146,17 +183,17 @@ static int    varset2svartable(BDD);
 
    /* Hashvalues */
 #define NOTHASH(r)           (r)
-#define APPLYHASH(l,r,op)    (TRIPLE(l,r,op))
-#define ITEHASH(f,g,h)       (TRIPLE(f,g,h))
-#define RESTRHASH(r,var)     (PAIR(r,var))
-#define CONSTRAINHASH(f,c)   (PAIR(f,c))
+#define APPLYHASH(l,r,op)    (CACHETRIPLE(l,r,op))
+#define ITEHASH(f,g,h)       (CACHETRIPLE(f,g,h))
+#define RESTRHASH(r,var)     (CACHEPAIR(r,var))
+#define CONSTRAINHASH(f,c)   (CACHEPAIR(f,c))
 #define QUANTHASH(r)         (r)
 #define REPLACEHASH(r)       (r)
 #define VECCOMPOSEHASH(f)    (f)
-#define COMPOSEHASH(f,g)     (PAIR(f,g))
+#define COMPOSEHASH(f,g)     (CACHEPAIR(f,g))
 #define SATCOUHASH(r)        (r)
 #define PATHCOUHASH(r)       (r)
-#define APPEXHASH(l,r,op)    (PAIR(l,r))
+#define APPEXHASH(l,r,op)    (CACHEPAIR(l,r))
 
 #ifndef M_LN2
 #define M_LN2 0.69314718055994530942
@@ -195,6 +232,13 @@ int bdd_operator_init(int cachesize)
    quantvarset = NULL;
    cacheratio = 0;
    supportSet = NULL;
+   satmemo = NULL;
+   satmemoset = NULL;
+   satmemosize = 0;
+#ifdef BDD_NONRECURSIVE
+   opstack = NULL;
+   opstacktop = 0;
+#endif
    
    return 0;
 }
@@ -214,6 +258,18 @@ void bdd_operator_done(void)
 
    if (supportSet != NULL)
      free(supportSet);
+
+   free(satmemo);
+   free(satmemoset);
+   satmemo = NULL;
+   satmemoset = NULL;
+   satmemosize = 0;
+
+#ifdef BDD_NONRECURSIVE
+   if (opstack != NULL)
+      free(opstack);
+   opstack = NULL;
+#endif
 }
 
 
@@ -238,6 +294,19 @@ void bdd_operator_varresize(void)
 
    memset(quantvarset, 0, sizeof(int)*bddvarnum);
    quantvarsetID = 0;
+
+#ifdef BDD_NONRECURSIVE
+   if (opstack != NULL)
+      free(opstack);
+
+   if ((opstack=NEW(BddFrame,3*bddvarnum+4)) == NULL)
+      bdd_error(BDD_MEMORY);
+   opstacktop = 0;
+#endif
+
+      /* Cached quantifications are keyed by quantvarsetID, which restarts
+	 here, and cached satcounts depend on bddvarnum: drop them all */
+   bdd_operator_reset();
 }
 
 
@@ -437,12 +506,12 @@ static BDD not_rec(BDD r)
    if (entry->a == r  &&  entry->c == bddop_not)
    {
 #ifdef CACHESTATS
-      bddcachestats.opHit++;
+      CACHEHIT(bddcache_apply);
 #endif
       return entry->r.res;
    }
 #ifdef CACHESTATS
-   bddcachestats.opMiss++;
+   CACHEMISS(bddcache_apply);
 #endif
    
    PUSHREF( not_rec(LOW(r)) );
@@ -536,11 +605,10 @@ BDD bdd_apply(BDD l, BDD r, int op)
 }
 
 
-static BDD apply_rec(BDD l, BDD r)
+   /* Terminal cases and cache lookup of apply. Returns the result, or -1
+      and the cache entry the result must be stored in */
+static BDD apply_shortcut(BDD l, BDD r, BddCacheData **entry)
 {
-   BddCacheData *entry;
-   BDD res;
-   
    switch (applyop)
    {
     case bddop_and:
@@ -590,53 +658,118 @@ static BDD apply_rec(BDD l, BDD r)
    }
 
    if (ISCONST(l)  &&  ISCONST(r))
-      res = oprres[applyop][l<<1 | r];
-   else
-   {
-      entry = BddCache_lookup(&applycache, APPLYHASH(l,r,applyop));
+      return oprres[applyop][l<<1 | r];
+
+   *entry = BddCache_lookup(&applycache, APPLYHASH(l,r,applyop));
       
-      if (entry->a == l  &&  entry->b == r  &&  entry->c == applyop)
-      {
+   if ((*entry)->a == l  &&  (*entry)->b == r  &&  (*entry)->c == applyop)
+   {
 #ifdef CACHESTATS
-	 bddcachestats.opHit++;
+      CACHEHIT(bddcache_apply);
 #endif
-	 return entry->r.res;
-      }
+      return (*entry)->r.res;
+   }
 #ifdef CACHESTATS
-      bddcachestats.opMiss++;
+   CACHEMISS(bddcache_apply);
 #endif
-      
-      if (LEVEL(l) == LEVEL(r))
-      {
-	 PUSHREF( apply_rec(LOW(l), LOW(r)) );
-	 PUSHREF( apply_rec(HIGH(l), HIGH(r)) );
-	 res = bdd_makenode(LEVEL(l), READREF(2), READREF(1));
-      }
-      else
-      if (LEVEL(l) < LEVEL(r))
-      {
-	 PUSHREF( apply_rec(LOW(l), r) );
-	 PUSHREF( apply_rec(HIGH(l), r) );
-	 res = bdd_makenode(LEVEL(l), READREF(2), READREF(1));
-      }
-      else
+   return -1;
+}
+
+
+   /* Operands of the low (high == 0) or high branch of the pair (l,r) */
+static void pair_branch(BDD l, BDD r, int high, BDD *bl, BDD *br)
+{
+   if (LEVEL(l) == LEVEL(r))
+   {
+      *bl = high ? HIGH(l) : LOW(l);
+      *br = high ? HIGH(r) : LOW(r);
+   }
+   else
+   if (LEVEL(l) < LEVEL(r))
+   {
+      *bl = high ? HIGH(l) : LOW(l);
+      *br = r;
+   }
+   else
+   {
+      *bl = l;
+      *br = high ? HIGH(r) : LOW(r);
+   }
+}
+
+
+#ifdef BDD_NONRECURSIVE
+
+static BDD apply_rec(BDD l, BDD r)
+{
+   int base = opstacktop;
+   BddCacheData *entry;
+   BddFrame *f;
+   BDD res, bl, br;
+
+   if ((res=apply_shortcut(l, r, &entry)) >= 0)
+      return res;
+   OPPUSH(l, r, entry);
+
+   while (opstacktop > base)
+   {
+      f = &opstack[opstacktop-1];
+
+      if (f->state < 2)
       {
-	 PUSHREF( apply_rec(l, LOW(r)) );
-	 PUSHREF( apply_rec(l, HIGH(r)) );
-	 res = bdd_makenode(LEVEL(r), READREF(2), READREF(1));
+	 pair_branch(f->a, f->b, f->state++, &bl, &br);
+	 if ((res=apply_shortcut(bl, br, &entry)) >= 0)
+	    PUSHREF(res);
+	 else
+	    OPPUSH(bl, br, entry);
+	 continue;
       }
 
+      res = bdd_makenode(MIN(LEVEL(f->a), LEVEL(f->b)),
+			 READREF(2), READREF(1));
       POPREF(2);
 
-      entry->a = l;
-      entry->b = r;
-      entry->c = applyop;
-      entry->r.res = res;
+      f->entry->a = f->a;
+      f->entry->b = f->b;
+      f->entry->c = applyop;
+      f->entry->r.res = res;
+
+      opstacktop--;
+      PUSHREF(res);
    }
 
+   res = READREF(1);
+   POPREF(1);
+   return res;
+}
+
+#else /* BDD_NONRECURSIVE */
+
+static BDD apply_rec(BDD l, BDD r)
+{
+   BddCacheData *entry = NULL;
+   BDD res, bl, br;
+
+   if ((res=apply_shortcut(l, r, &entry)) >= 0)
+      return res;
+
+   pair_branch(l, r, 0, &bl, &br);
+   PUSHREF( apply_rec(bl, br) );
+   pair_branch(l, r, 1, &bl, &br);
+   PUSHREF( apply_rec(bl, br) );
+   res = bdd_makenode(MIN(LEVEL(l), LEVEL(r)), READREF(2), READREF(1));
+   POPREF(2);
+
+   entry->a = l;
+   entry->b = r;
+   entry->c = applyop;
+   entry->r.res = res;
+
    return res;
 }
 
+#endif /* BDD_NONRECURSIVE */
+
 
 /*
 NAME    {* bdd\_and *}
@@ -782,12 +915,12 @@ static BDD ite_rec(BDD f, BDD g, BDD h)
    if (entry->a == f  &&  entry->b == g  &&  entry->c == h)
    {
 #ifdef CACHESTATS
-      bddcachestats.opHit++;
+      CACHEHIT(bddcache_ite);
 #endif
       return entry->r.res;
    }
 #ifdef CACHESTATS
-   bddcachestats.opMiss++;
+   CACHEMISS(bddcache_ite);
 #endif
       
    if (LEVEL(f) == LEVEL(g))
@@ -949,12 +1082,12 @@ static int restrict_rec(int r)
    if (entry->a == r  &&  entry->c == miscid)
    {
 #ifdef CACHESTATS
-      bddcachestats.opHit++;
+      CACHEHIT(bddcache_misc);
 #endif
       return entry->r.res;
    }
 #ifdef CACHESTATS
-   bddcachestats.opMiss++;
+   CACHEMISS(bddcache_misc);
 #endif
    
    if (INSVARSET(LEVEL(r)))
@@ -1044,12 +1177,12 @@ static BDD constrain_rec(BDD f, BDD c)
    if (entry->a == f  &&  entry->b == c  &&  entry->c == miscid)
    {
 #ifdef CACHESTATS
-      bddcachestats.opHit++;
+      CACHEHIT(bddcache_misc);
 #endif
       return entry->r.res;
    }
 #ifdef CACHESTATS
-   bddcachestats.opMiss++;
+   CACHEMISS(bddcache_misc);
 #endif
 
    if (LEVEL(f) == LEVEL(c))
@@ -1148,25 +1281,134 @@ BDD bdd_replace(BDD r, bddPair *pair)
 }
 
 
-static BDD replace_rec(BDD r)
+   /* Terminal cases and cache lookup of replace. Returns the result, or -1
+      and the cache entry the result must be stored in */
+static BDD replace_shortcut(BDD r, BddCacheData **entry)
 {
-   BddCacheData *entry;
-   BDD res;
-   
    if (ISCONST(r)  ||  LEVEL(r) > replacelast)
       return r;
 
-   entry = BddCache_lookup(&replacecache, REPLACEHASH(r));
-   if (entry->a == r  &&  entry->c == replaceid)
+   *entry = BddCache_lookup(&replacecache, REPLACEHASH(r));
+   if ((*entry)->a == r  &&  (*entry)->c == replaceid)
    {
 #ifdef CACHESTATS
-      bddcachestats.opHit++;
+      CACHEHIT(bddcache_replace);
 #endif
-      return entry->r.res;
+      return (*entry)->r.res;
    }
 #ifdef CACHESTATS
-   bddcachestats.opMiss++;
+   CACHEMISS(bddcache_replace);
 #endif
+   return -1;
+}
+
+
+   /* Terminal cases of bdd_correctify. Returns the result or -1 */
+static BDD correctify_shortcut(int level, BDD l, BDD r)
+{
+   if (level < LEVEL(l)  &&  level < LEVEL(r))
+      return bdd_makenode(level, l, r);
+
+   if (level == LEVEL(l)  ||  level == LEVEL(r))
+   {
+      bdd_error(BDD_REPLACE);
+      return 0;
+   }
+   return -1;
+}
+
+
+#ifdef BDD_NONRECURSIVE
+
+static BDD replace_rec(BDD r)
+{
+   int base = opstacktop;
+   BddCacheData *entry;
+   BddFrame *f;
+   BDD res, n;
+
+   if ((res=replace_shortcut(r, &entry)) >= 0)
+      return res;
+   OPPUSH(r, 0, entry);
+
+   while (opstacktop > base)
+   {
+      f = &opstack[opstacktop-1];
+
+      if (f->state < 2)
+      {
+	 n = f->state++ ? HIGH(f->a) : LOW(f->a);
+	 if ((res=replace_shortcut(n, &entry)) >= 0)
+	    PUSHREF(res);
+	 else
+	    OPPUSH(n, 0, entry);
+	 continue;
+      }
+
+      res = bdd_correctify(LEVEL(replacepair[LEVEL(f->a)]),
+			   READREF(2), READREF(1));
+      POPREF(2);
+
+      f->entry->a = f->a;
+      f->entry->c = replaceid;
+      f->entry->r.res = res;
+
+      opstacktop--;
+      PUSHREF(res);
+   }
+
+   res = READREF(1);
+   POPREF(1);
+   return res;
+}
+
+
+static BDD bdd_correctify(int level, BDD l, BDD r)
+{
+   int base = opstacktop;
+   BddFrame *f;
+   BDD res, bl, br;
+
+   if ((res=correctify_shortcut(level, l, r)) >= 0)
+      return res;
+   OPPUSH(l, r, NULL);
+
+   while (opstacktop > base)
+   {
+      f = &opstack[opstacktop-1];
+
+      if (f->state < 2)
+      {
+	 pair_branch(f->a, f->b, f->state++, &bl, &br);
+	 if ((res=correctify_shortcut(level, bl, br)) >= 0)
+	    PUSHREF(res);
+	 else
+	    OPPUSH(bl, br, NULL);
+	 continue;
+      }
+
+      res = bdd_makenode(MIN(LEVEL(f->a), LEVEL(f->b)),
+			 READREF(2), READREF(1));
+      POPREF(2);
+
+      opstacktop--;
+      PUSHREF(res);
+   }
+
+   res = READREF(1);
+   POPREF(1);
+   return res; /* FIXME: cache ? */
+}
+
+#else /* BDD_NONRECURSIVE */
+
+static BDD replace_rec(BDD r)
+{
+   BddCacheData *entry = NULL;
+   BDD res;
+   
+   if ((res=replace_shortcut(r, &entry)) >= 0)
+      return res;
 
    PUSHREF( replace_rec(LOW(r)) );
    PUSHREF( replace_rec(HIGH(r)) );
@@ -1184,41 +1426,23 @@ static BDD replace_rec(BDD r)
 
 static BDD bdd_correctify(int level, BDD l, BDD r)
 {
-   BDD res;
+   BDD res, bl, br;
    
-   if (level < LEVEL(l)  &&  level < LEVEL(r))
-      return bdd_makenode(level, l, r);
-
-   if (level == LEVEL(l)  ||  level == LEVEL(r))
-   {
-      bdd_error(BDD_REPLACE);
-      return 0;
-   }
+   if ((res=correctify_shortcut(level, l, r)) >= 0)
+      return res;
 
-   if (LEVEL(l) == LEVEL(r))
-   {
-      PUSHREF( bdd_correctify(level, LOW(l), LOW(r)) );
-      PUSHREF( bdd_correctify(level, HIGH(l), HIGH(r)) );
-      res = bdd_makenode(LEVEL(l), READREF(2), READREF(1));
-   }
-   else
-   if (LEVEL(l) < LEVEL(r))
-   {
-      PUSHREF( bdd_correctify(level, LOW(l), r) );
-      PUSHREF( bdd_correctify(level, HIGH(l), r) );
-      res = bdd_makenode(LEVEL(l), READREF(2), READREF(1));
-   }
-   else
-   {
-      PUSHREF( bdd_correctify(level, l, LOW(r)) );
-      PUSHREF( bdd_correctify(level, l, HIGH(r)) );
-      res = bdd_makenode(LEVEL(r), READREF(2), READREF(1));
-   }
+   pair_branch(l, r, 0, &bl, &br);
+   PUSHREF( bdd_correctify(level, bl, br) );
+   pair_branch(l, r, 1, &bl, &br);
+   PUSHREF( bdd_correctify(level, bl, br) );
+   res = bdd_makenode(MIN(LEVEL(l), LEVEL(r)), READREF(2), READREF(1));
    POPREF(2);
    
    return res; /* FIXME: cache ? */
 }
 
+#endif /* BDD_NONRECURSIVE */
+
 
 /*=== COMPOSE ==========================================================*/
 
@@ -1284,12 +1508,12 @@ static BDD compose_rec(BDD f, BDD g)
    if (entry->a == f  &&  entry->b == g  &&  entry->c == replaceid)
    {
 #ifdef CACHESTATS
-      bddcachestats.opHit++;
+      CACHEHIT(bddcache_replace);
 #endif
       return entry->r.res;
    }
 #ifdef CACHESTATS
-   bddcachestats.opMiss++;
+   CACHEMISS(bddcache_replace);
 #endif
 
    if (LEVEL(f) < composelevel)
@@ -1397,12 +1621,12 @@ static BDD veccompose_rec(BDD f)
    if (entry->a == f  &&  entry->c == replaceid)
    {
 #ifdef CACHESTATS
-      bddcachestats.opHit++;
+      CACHEHIT(bddcache_replace);
 #endif
       return entry->r.res;
    }
 #ifdef CACHESTATS
-   bddcachestats.opMiss++;
+   CACHEMISS(bddcache_replace);
 #endif
 
    PUSHREF( veccompose_rec(LOW(f)) );
@@ -1483,12 +1707,12 @@ static BDD simplify_rec(BDD f, BDD d)
    if (entry->a == f  &&  entry->b == d  &&  entry->c == bddop_simplify)
    {
 #ifdef CACHESTATS
-      bddcachestats.opHit++;
+      CACHEHIT(bddcache_apply);
 #endif
       return entry->r.res;
    }
 #ifdef CACHESTATS
-   bddcachestats.opMiss++;
+   CACHEMISS(bddcache_apply);
 #endif
    
    if (LEVEL(f) == LEVEL(d))
@@ -1688,25 +1912,84 @@ BDD bdd_unique(BDD r, BDD var)
 }
 
 
-static int quant_rec(int r)
+   /* Terminal cases and cache lookup of quant. Returns the result, or -1
+      and the cache entry the result must be stored in */
+static int quant_shortcut(int r, BddCacheData **entry)
 {
-   BddCacheData *entry;
-   int res;
-   
    if (r < 2  ||  LEVEL(r) > quantlast)
       return r;
 
-   entry = BddCache_lookup(&quantcache, QUANTHASH(r));
-   if (entry->a == r  &&  entry->c == quantid)
+   *entry = BddCache_lookup(&quantcache, QUANTHASH(r));
+   if ((*entry)->a == r  &&  (*entry)->c == quantid)
    {
 #ifdef CACHESTATS
-      bddcachestats.opHit++;
+      CACHEHIT(bddcache_quant);
 #endif
-      return entry->r.res;
+      return (*entry)->r.res;
    }
 #ifdef CACHESTATS
-   bddcachestats.opMiss++;
+   CACHEMISS(bddcache_quant);
 #endif
+   return -1;
+}
+
+
+#ifdef BDD_NONRECURSIVE
+
+static int quant_rec(int r)
+{
+   int base = opstacktop;
+   BddCacheData *entry;
+   BddFrame *f;
+   int res, n;
+
+   if ((res=quant_shortcut(r, &entry)) >= 0)
+      return res;
+   OPPUSH(r, 0, entry);
+
+   while (opstacktop > base)
+   {
+      f = &opstack[opstacktop-1];
+
+      if (f->state < 2)
+      {
+	 n = f->state++ ? HIGH(f->a) : LOW(f->a);
+	 if ((res=quant_shortcut(n, &entry)) >= 0)
+	    PUSHREF(res);
+	 else
+	    OPPUSH(n, 0, entry);
+	 continue;
+      }
+
+	 /* The nested apply only uses frames above this one */
+      if (INVARSET(LEVEL(f->a)))
+	 res = apply_rec(READREF(2), READREF(1));
+      else
+	 res = bdd_makenode(LEVEL(f->a), READREF(2), READREF(1));
+      POPREF(2);
+
+      f->entry->a = f->a;
+      f->entry->c = quantid;
+      f->entry->r.res = res;
+
+      opstacktop--;
+      PUSHREF(res);
+   }
+
+   res = READREF(1);
+   POPREF(1);
+   return res;
+}
+
+#else /* BDD_NONRECURSIVE */
+
+static int quant_rec(int r)
+{
+   BddCacheData *entry = NULL;
+   int res;
+   
+   if ((res=quant_shortcut(r, &entry)) >= 0)
+      return res;
 
    PUSHREF( quant_rec(LOW(r)) );
    PUSHREF( quant_rec(HIGH(r)) );
@@ -1725,6 +2008,8 @@ static int quant_rec(int r)
    return res;
 }
 
+#endif /* BDD_NONRECURSIVE */
+
 
 /*=== APPLY & QUANTIFY =================================================*/
 
@@ -1928,11 +2213,10 @@ BDD bdd_appuni(BDD l, BDD r, int opr, BDD var)
 }
 
 
-static int appquant_rec(int l, int r)
+   /* Terminal cases and cache lookup of appquant. Returns the result, or -1
+      and the cache entry the result must be stored in */
+static int appquant_shortcut(int l, int r, BddCacheData **entry)
 {
-   BddCacheData *entry;
-   int res;
-
    switch (appexop)
    {
     case bddop_and:
@@ -1974,69 +2258,112 @@ static int appquant_rec(int l, int r)
    }
    
    if (ISCONST(l)  &&  ISCONST(r))
-      res = oprres[appexop][(l<<1) | r];
-   else
+      return oprres[appexop][(l<<1) | r];
+
    if (LEVEL(l) > quantlast  &&  LEVEL(r) > quantlast)
    {
-      int oldop = applyop;
+      int res, oldop = applyop;
       applyop = appexop;
       res = apply_rec(l,r);
       applyop = oldop;
+      return res;
    }
-   else
+
+   *entry = BddCache_lookup(&appexcache, APPEXHASH(l,r,appexop));
+   if ((*entry)->a == l  &&  (*entry)->b == r  &&  (*entry)->c == appexid)
    {
-      entry = BddCache_lookup(&appexcache, APPEXHASH(l,r,appexop));
-      if (entry->a == l  &&  entry->b == r  &&  entry->c == appexid)
-      {
 #ifdef CACHESTATS
-	 bddcachestats.opHit++;
+      CACHEHIT(bddcache_appex);
 #endif
-	 return entry->r.res;
-      }
+      return (*entry)->r.res;
+   }
 #ifdef CACHESTATS
-      bddcachestats.opMiss++;
+   CACHEMISS(bddcache_appex);
 #endif
+   return -1;
+}
 
-      if (LEVEL(l) == LEVEL(r))
-      {
-	 PUSHREF( appquant_rec(LOW(l), LOW(r)) );
-	 PUSHREF( appquant_rec(HIGH(l), HIGH(r)) );
-	 if (INVARSET(LEVEL(l)))
-	    res = apply_rec(READREF(2), READREF(1));
-	 else
-	    res = bdd_makenode(LEVEL(l), READREF(2), READREF(1));
-      }
-      else
-      if (LEVEL(l) < LEVEL(r))
-      {
-	 PUSHREF( appquant_rec(LOW(l), r) );
-	 PUSHREF( appquant_rec(HIGH(l), r) );
-	 if (INVARSET(LEVEL(l)))
-	    res = apply_rec(READREF(2), READREF(1));
-	 else
-	    res = bdd_makenode(LEVEL(l), READREF(2), READREF(1));
-      }
-      else
+
+#ifdef BDD_NONRECURSIVE
+
+static int appquant_rec(int l, int r)
+{
+   int base = opstacktop;
+   BddCacheData *entry;
+   BddFrame *f;
+   int res, level, bl, br;
+
+   if ((res=appquant_shortcut(l, r, &entry)) >= 0)
+      return res;
+   OPPUSH(l, r, entry);
+
+   while (opstacktop > base)
+   {
+      f = &opstack[opstacktop-1];
+
+      if (f->state < 2)
       {
-	 PUSHREF( appquant_rec(l, LOW(r)) );
-	 PUSHREF( appquant_rec(l, HIGH(r)) );
-	 if (INVARSET(LEVEL(r)))
-	    res = apply_rec(READREF(2), READREF(1));
+	 pair_branch(f->a, f->b, f->state++, &bl, &br);
+	 if ((res=appquant_shortcut(bl, br, &entry)) >= 0)
+	    PUSHREF(res);
 	 else
-	    res = bdd_makenode(LEVEL(r), READREF(2), READREF(1));
+	    OPPUSH(bl, br, entry);
+	 continue;
       }
 
+      level = MIN(LEVEL(f->a), LEVEL(f->b));
+      if (INVARSET(level))
+	 res = apply_rec(READREF(2), READREF(1));
+      else
+	 res = bdd_makenode(level, READREF(2), READREF(1));
       POPREF(2);
-      
-      entry->a = l;
-      entry->b = r;
-      entry->c = appexid;
-      entry->r.res = res;
+
+      f->entry->a = f->a;
+      f->entry->b = f->b;
+      f->entry->c = appexid;
+      f->entry->r.res = res;
+
+      opstacktop--;
+      PUSHREF(res);
    }
 
+   res = READREF(1);
+   POPREF(1);
    return res;
 }
 
+#else /* BDD_NONRECURSIVE */
+
+static int appquant_rec(int l, int r)
+{
+   BddCacheData *entry = NULL;
+   int res, level, bl, br;
+
+   if ((res=appquant_shortcut(l, r, &entry)) >= 0)
+      return res;
+
+   pair_branch(l, r, 0, &bl, &br);
+   PUSHREF( appquant_rec(bl, br) );
+   pair_branch(l, r, 1, &bl, &br);
+   PUSHREF( appquant_rec(bl, br) );
+
+   level = MIN(LEVEL(l), LEVEL(r));
+   if (INVARSET(level))
+      res = apply_rec(READREF(2), READREF(1));
+   else
+      res = bdd_makenode(level, READREF(2), READREF(1));
+   POPREF(2);
+      
+   entry->a = l;
+   entry->b = r;
+   entry->c = appexid;
+   entry->r.res = res;
+
+   return res;
+}
+
+#endif /* BDD_NONRECURSIVE */
+
 
 /*************************************************************************
   Informational functions
@@ -2457,7 +2784,13 @@ DESCR   {* Calculates how many possible variable assignments there exists
 	   variables are considered in the first version. In the
 	   second version, only the variables in the variable
 	   set {\tt varset} are considered. This makes the function a
-	   {\em lot} slower. *}
+	   {\em lot} slower.
+
+	   The counts of the nodes are kept in a table with one entry
+	   per node in the node table (12 bytes per node, allocated on
+	   first use), not in the operator caches, so each node of
+	   {\tt r} is counted exactly once and the time is linear in
+	   the size of {\tt r}. *}
 ALSO    {* bdd\_satone, bdd\_fullsatone, bdd\_satcountln *}
 RETURN  {* The number of possible assignments. *}
 */
@@ -2467,10 +2800,39 @@ double bdd_satcount(BDD r)
 
    CHECKa(r, 0.0);
 
-   miscid = CACHEID_SATCOU;
+      /* No nodes are created while counting, so the table only has to
+	 match the node table at the start of the call */
+   if (satmemosize < bddnodesize)
+   {
+      double *newmemo = (double*)realloc(satmemo, sizeof(double)*bddnodesize);
+      int *newset;
+      int n;
+
+      if (newmemo == NULL)
+	 return bdd_error(BDD_MEMORY);
+      satmemo = newmemo;
+      if ((newset=(int*)realloc(satmemoset, sizeof(int)*bddnodesize)) == NULL)
+	 return bdd_error(BDD_MEMORY);
+      satmemoset = newset;
+
+      for (n=satmemosize ; n<bddnodesize ; n++)
+	 satmemo[n] = -1.0;
+      satmemosize = bddnodesize;
+   }
+
    size = pow(2.0, (double)LEVEL(r));
+#ifdef BDD_NONRECURSIVE
+   opstacktop = 0;
+#endif
+   satmemotop = 0;
+
+   size *= satcount_rec(r);
+
+      /* Leave the table unset for the next call */
+   while (satmemotop > 0)
+      satmemo[satmemoset[--satmemotop]] = -1.0;
    
-   return size * satcount_rec(r);
+   return size;
 }
 
 
@@ -2491,37 +2853,76 @@ double bdd_satcountset(BDD r, BDD varset)
 }
 
 
+#ifdef BDD_NONRECURSIVE
+
 static double satcount_rec(int root)
 {
-   BddCacheData *entry;
-   BddNode *node;
-   double size, s;
+   int base = opstacktop;
+   BddFrame *f;
+   double size;
+   int n;
    
    if (root < 2)
       return root;
 
-   entry = BddCache_lookup(&misccache, SATCOUHASH(root));
-   if (entry->a == root  &&  entry->c == miscid)
-      return entry->r.dres;
+   if (satmemo[root] >= 0.0)
+      return satmemo[root];
+   OPPUSH(root, 0, NULL);
 
-   node = &bddnodes[root];
-   size = 0;
-   s = 1;
+   for (;;)
+   {
+      f = &opstack[opstacktop-1];
 
-   s *= pow(2.0, (float)(LEVEL(LOWp(node)) - LEVELp(node) - 1));
-   size += s * satcount_rec(LOWp(node));
+      if (f->state < 2)
+      {
+	 n = f->state++ ? HIGH(f->a) : LOW(f->a);
+	 if (n < 2)
+	    size = n;
+	 else if ((size=satmemo[n]) < 0.0)
+	 {
+	    OPPUSH(n, 0, NULL);
+	    continue;
+	 }
+      }
+      else
+      {
+	 satmemo[f->a] = size = f->dres;
+	 satmemoset[satmemotop++] = f->a;
+	 n = f->a;
+	 if (--opstacktop == base)
+	    return size;
+	 f = &opstack[opstacktop-1];
+      }
 
-   s = 1;
-   s *= pow(2.0, (float)(LEVEL(HIGHp(node)) - LEVELp(node) - 1));
-   size += s * satcount_rec(HIGHp(node));
+	 /* Add the count of the branch n to its parent */
+      f->dres += ldexp(size, LEVEL(n) - LEVEL(f->a) - 1);
+   }
+}
 
-   entry->a = root;
-   entry->c = miscid;
-   entry->r.dres = size;
+#else /* BDD_NONRECURSIVE */
+
+static double satcount_rec(int root)
+{
+   BddNode *node;
+   double size;
    
+   if (root < 2)
+      return root;
+
+   if (satmemo[root] >= 0.0)
+      return satmemo[root];
+
+   node = &bddnodes[root];
+   size = ldexp(satcount_rec(LOWp(node)), LEVEL(LOWp(node)) - LEVELp(node) - 1);
+   size += ldexp(satcount_rec(HIGHp(node)), LEVEL(HIGHp(node)) - LEVELp(node) - 1);
+
+   satmemo[root] = size;
+   satmemoset[satmemotop++] = root;
    return size;
 }
 
+#endif /* BDD_NONRECURSIVE */
+
 
 /*
 NAME    {* bdd\_satcountln *}
@@ -42,11 +42,26 @@
 /*************************************************************************
 *************************************************************************/
 
+   /* Table size for a requested size: next prime, or next power of two
+      in BDD_POW2CACHE mode */
+static int BddCache_tablesize(int size)
+{
+#ifdef BDD_POW2CACHE
+   int pow2 = 1;
+   while (pow2 < size  &&  pow2 < (1 << 30))
+      pow2 <<= 1;
+   return pow2;
+#else
+   return bdd_prime_gte(size);
+#endif
+}
+
+
 int BddCache_init(BddCache *cache, int size)
 {
    int n;
 
-   size = bdd_prime_gte(size);
+   size = BddCache_tablesize(size);
    
    if ((cache->table=NEW(BddCacheData,size)) == NULL)
       return bdd_error(BDD_MEMORY);
@@ -54,6 +69,7 @@ int BddCache_init(BddCache *cache, int size)
    for (n=0 ; n<size ; n++)
       cache->table[n].a = -1;
    cache->tablesize = size;
+   cache->mask = (unsigned int)size - 1;
    
    return 0;
 }
@@ -64,6 +80,7 @@ void BddCache_done(BddCache *cache)
    free(cache->table);
    cache->table = NULL;
    cache->tablesize = 0;
+   cache->mask = 0;
 }
 
 
@@ -73,7 +90,7 @@ int BddCache_resize(BddCache *cache, int newsize)
 
    free(cache->table);
 
-   newsize = bdd_prime_gte(newsize);
+   newsize = BddCache_tablesize(newsize);
    
    if ((cache->table=NEW(BddCacheData,newsize)) == NULL)
       return bdd_error(BDD_MEMORY);
@@ -81,6 +98,7 @@ int BddCache_resize(BddCache *cache, int newsize)
    for (n=0 ; n<newsize ; n++)
       cache->table[n].a = -1;
    cache->tablesize = newsize;
+   cache->mask = (unsigned int)newsize - 1;
    
    return 0;
 }
@@ -53,6 +53,7 @@ typedef struct
 {
    BddCacheData *table;
    int tablesize;
+   unsigned int mask;      /* tablesize-1 when BDD_POW2CACHE is defined */
 } BddCache;
 
 
@@ -61,8 +62,35 @@ extern void BddCache_done(BddCache *);
 extern int  BddCache_resize(BddCache *, int);
 extern void BddCache_reset(BddCache *);
 
+#ifdef BDD_POW2CACHE
+
+#if defined(_MSC_VER)
+#define BDDCACHE_INLINE __inline
+#else
+#define BDDCACHE_INLINE __inline__
+#endif
+
+   /* Power-of-two tables are indexed by the low bits of the hash, so the
+      hash is run through a full avalanche finalizer (murmur3 fmix32)
+      first; this replaces the integer division of the modulo lookup. */
+static BDDCACHE_INLINE unsigned int BddCache_mix(unsigned int h)
+{
+   h ^= h >> 16;
+   h *= 0x85EBCA6BU;
+   h ^= h >> 13;
+   h *= 0xC2B2AE35U;
+   h ^= h >> 16;
+   return h;
+}
+
+#define BddCache_lookup(cache, hash) (&(cache)->table[BddCache_mix(hash) & (cache)->mask])
+
+#else
+
 #define BddCache_lookup(cache, hash) (&(cache)->table[hash % (cache)->tablesize])
 
+#endif /* BDD_POW2CACHE */
+
 
 #endif /* _CACHE_H */
 
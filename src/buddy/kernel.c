@@ -49,6 +49,13 @@
 #include "cache.h"
 #include "prime.h"
 
+#if defined(BDD_COMPACTNODES) && defined(BDD_HUGEPAGES) && !defined(_WIN32)
+#include <sys/mman.h>
+#endif
+#if defined(BDD_COMPACTNODES) && defined(_WIN32)
+#include <malloc.h>
+#endif
+
 /*************************************************************************
   Various definitions and global variables
 *************************************************************************/
@@ -91,12 +98,18 @@ int          bddnodesize;           /* Number of allocated nodes */
 int          bddmaxnodesize;        /* Maximum allowed number of nodes */
 int          bddmaxnodeincrease;    /* Max. # of nodes used to inc. table */
 BddNode*     bddnodes;          /* All of the bdd nodes */
+#ifdef BDD_COMPACTNODES
+int*         bddhash;           /* Unique table bucket heads */
+#endif
 int          bddfreepos;        /* First free node */
 int          bddfreenum;        /* Number of free nodes */
 long int     bddproduced;       /* Number of new nodes ever produced */
 int          bddvarnum;         /* Number of defined BDD variables */
 int*         bddrefstack;       /* Internal node reference stack */
 int*         bddrefstacktop;    /* Internal node reference stack top */
+#ifdef BDD_NONRECURSIVE
+static int*  bddmarkstack;      /* Pending high branches in bdd_mark() */
+#endif
 int*         bddvar2level;      /* Variable -> level table */
 int*         bddlevel2var;      /* Level -> variable table */
 jmp_buf      bddexception;      /* Long-jump point for interrupting calc. */
@@ -142,6 +155,99 @@ static char *errorstrings[BDD_ERRNUM] =
 #define NODEHASH(lvl,l,h) (TRIPLE(lvl,l,h) % bddnodesize)
 
 
+/*=== NODE TABLE MEMORY ================================================*/
+
+   /* The node table (and with BDD_COMPACTNODES the bucket array) goes
+      through these functions. Compact tables are aligned to a cache line
+      so a 16 byte node never straddles two lines; with BDD_HUGEPAGES they
+      are anonymous mappings that ask for huge pages (explicit MAP_HUGETLB
+      first, transparent huge pages otherwise). Tables are never shrunk, so
+      a resize is a plain allocate/copy/free. */
+
+#ifdef BDD_COMPACTNODES
+
+#define BDD_CACHELINE 64
+
+#if defined(BDD_HUGEPAGES) && !defined(_WIN32)
+
+#define BDD_HUGEPAGESIZE ((size_t)2*1024*1024)
+#define HUGEROUND(s) (((s) + BDD_HUGEPAGESIZE-1) & ~(BDD_HUGEPAGESIZE-1))
+
+static void *bdd_tablealloc(size_t size)
+{
+   void *p;
+
+   size = HUGEROUND(size);
+#ifdef MAP_HUGETLB
+   p = mmap(NULL, size, PROT_READ|PROT_WRITE,
+	    MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0);
+   if (p != MAP_FAILED)
+      return p;
+#endif
+   p = mmap(NULL, size, PROT_READ|PROT_WRITE,
+	    MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+   if (p == MAP_FAILED)
+      return NULL;
+#ifdef MADV_HUGEPAGE
+   madvise(p, size, MADV_HUGEPAGE);
+#endif
+   return p;
+}
+
+
+static void bdd_tablefree(void *p, size_t size)
+{
+   if (p != NULL)
+      munmap(p, HUGEROUND(size));
+}
+
+#else /* BDD_HUGEPAGES */
+
+static void *bdd_tablealloc(size_t size)
+{
+#ifdef _WIN32
+   return _aligned_malloc(size, BDD_CACHELINE);
+#else
+   void *p;
+   if (posix_memalign(&p, BDD_CACHELINE, size) != 0)
+      return NULL;
+   return p;
+#endif
+}
+
+
+static void bdd_tablefree(void *p, size_t size)
+{
+   (void)size;
+#ifdef _WIN32
+   _aligned_free(p);
+#else
+   free(p);
+#endif
+}
+
+#endif /* BDD_HUGEPAGES */
+
+
+static void *bdd_tablerealloc(void *old, size_t oldsize, size_t size)
+{
+   void *p = bdd_tablealloc(size);
+   if (p == NULL)
+      return NULL;
+   memcpy(p, old, MIN(oldsize, size));
+   bdd_tablefree(old, oldsize);
+   return p;
+}
+
+#else /* BDD_COMPACTNODES */
+
+#define bdd_tablealloc(size)                malloc(size)
+#define bdd_tablerealloc(old,oldsize,size)  realloc(old,size)
+#define bdd_tablefree(p,size)               free(p)
+
+#endif /* BDD_COMPACTNODES */
+
+
 /*************************************************************************
   BDD misc. user operations
 *************************************************************************/
@@ -180,8 +286,16 @@ int bdd_init(int initnodesize, int cs)
    
    bddnodesize = bdd_prime_gte(initnodesize);
    
-   if ((bddnodes=(BddNode*)malloc(sizeof(BddNode)*bddnodesize)) == NULL)
+   if ((bddnodes=(BddNode*)bdd_tablealloc(sizeof(BddNode)*bddnodesize)) == NULL)
+      return bdd_error(BDD_MEMORY);
+#ifdef BDD_COMPACTNODES
+   if ((bddhash=(int*)bdd_tablealloc(sizeof(int)*bddnodesize)) == NULL)
+   {
+      bdd_tablefree(bddnodes, sizeof(BddNode)*bddnodesize);
+      bddnodes = NULL;
       return bdd_error(BDD_MEMORY);
+   }
+#endif
 
    bddresized = 0;
    
@@ -189,7 +303,7 @@ int bdd_init(int initnodesize, int cs)
    {
       bddnodes[n].refcou = 0;
       LOW(n) = -1;
-      bddnodes[n].hash = 0;
+      BUCKET(n) = 0;
       LEVEL(n) = 0;
       bddnodes[n].next = n+1;
    }
@@ -224,6 +338,8 @@ int bdd_init(int initnodesize, int cs)
    bddcachestats.opHit = 0;
    bddcachestats.opMiss = 0;
    bddcachestats.swapCount = 0;
+   memset(bddcachestats.opHitCache, 0, sizeof(bddcachestats.opHitCache));
+   memset(bddcachestats.opMissCache, 0, sizeof(bddcachestats.opMissCache));
  
    bdd_gbc_hook(bdd_default_gbchandler);
    bdd_error_hook(bdd_default_errhandler);
@@ -255,8 +371,16 @@ void bdd_done(void)
    bdd_reorder_done();
    bdd_pairs_done();
    
-   free(bddnodes);
+   bdd_tablefree(bddnodes, sizeof(BddNode)*bddnodesize);
+#ifdef BDD_COMPACTNODES
+   bdd_tablefree(bddhash, sizeof(int)*bddnodesize);
+   bddhash = NULL;
+#endif
    free(bddrefstack);
+#ifdef BDD_NONRECURSIVE
+   free(bddmarkstack);
+   bddmarkstack = NULL;
+#endif
    free(bddvarset);
    free(bddvar2level);
    free(bddlevel2var);
@@ -346,6 +470,13 @@ int bdd_setvarnum(int num)
       free(bddrefstack);
    bddrefstack = bddrefstacktop = (int*)malloc(sizeof(int)*(num*2+4));
 
+#ifdef BDD_NONRECURSIVE
+      /* bdd_mark() stacks at most one branch per level */
+   if (bddmarkstack != NULL)
+      free(bddmarkstack);
+   bddmarkstack = (int*)malloc(sizeof(int)*(num+4));
+#endif
+
    for(bdv=bddvarnum ; bddvarnum < num; bddvarnum++)
    {
       bddvarset[bddvarnum*2] = PUSHREF( bdd_makenode(bddvarnum, 0, 1) );
@@ -744,12 +875,15 @@ DESCR   {* Prints information about the cache performance on standard output
 	   accesses to the unique node table, the number of times a node
 	   was (not) found there and how many times a hash chain had to
 	   traversed. Hit and miss count is also given for the operator
-	   caches. *}
+	   caches, in total and for each cache that was used. *}
 ALSO    {* bddCacheStat, bdd\_cachestats *}
 */
 void bdd_fprintstat(FILE *ofile)
 {
+   static const char *names[BDD_OPCACHENUM] =
+      { "apply", "ite", "quant", "appex", "replace", "misc" };
    bddCacheStat s;
+   int n;
    bdd_cachestats(&s);
    
    fprintf(ofile, "\nCache statistics\n");
@@ -759,6 +893,9 @@ void bdd_fprintstat(FILE *ofile)
    fprintf(ofile, "Unique Chain:   %ld\n", s.uniqueChain);
    fprintf(ofile, "Unique Hit:     %ld\n", s.uniqueHit);
    fprintf(ofile, "Unique Miss:    %ld\n", s.uniqueMiss);
+   fprintf(ofile, "=> Chain/access = %.2f\n",
+	   (s.uniqueAccess > 0) ?
+	   ((float)s.uniqueChain)/((float)s.uniqueAccess) : 0);
    fprintf(ofile, "=> Hit rate =   %.2f\n",
 	   (s.uniqueHit+s.uniqueMiss > 0) ? 
 	   ((float)s.uniqueHit)/((float)s.uniqueHit+s.uniqueMiss) : 0);
@@ -767,6 +904,13 @@ void bdd_fprintstat(FILE *ofile)
    fprintf(ofile, "=> Hit rate =   %.2f\n",
 	   (s.opHit+s.opMiss > 0) ? 
 	   ((float)s.opHit)/((float)s.opHit+s.opMiss) : 0);
+   for (n=0 ; n<BDD_OPCACHENUM ; n++)
+   {
+      unsigned long acc = s.opHitCache[n] + s.opMissCache[n];
+      if (acc > 0)
+	 fprintf(ofile, "   %-8s %10lu hits / %10lu = %.2f\n", names[n],
+		 s.opHitCache[n], acc, ((float)s.opHitCache[n])/((float)acc));
+   }
    fprintf(ofile, "Swap count =    %ld\n", s.swapCount);
 }
 
@@ -1015,8 +1159,8 @@ static void bdd_gbc_rehash(void)
 	 register unsigned int hash;
 
 	 hash = NODEHASH(LEVELp(node), LOWp(node), HIGHp(node));
-	 node->next = bddnodes[hash].hash;
-	 bddnodes[hash].hash = n;
+	 node->next = BUCKET(hash);
+	 BUCKET(hash) = n;
       }
       else
       {
@@ -1052,7 +1196,7 @@ void bdd_gbc(void)
    {
       if (bddnodes[n].refcou > 0)
 	 bdd_mark(n);
-      bddnodes[n].hash = 0;
+      BUCKET(n) = 0;
    }
    
    bddfreepos = 0;
@@ -1068,8 +1212,8 @@ void bdd_gbc(void)
 
 	 LEVELp(node) &= MARKOFF;
 	 hash = NODEHASH(LEVELp(node), LOWp(node), HIGHp(node));
-	 node->next = bddnodes[hash].hash;
-	 bddnodes[hash].hash = n;
+	 node->next = BUCKET(hash);
+	 BUCKET(hash) = n;
       }
       else
       {
@@ -1156,6 +1300,38 @@ BDD bdd_delref(BDD root)
 
 /*=== RECURSIVE MARK / UNMARK ==========================================*/
 
+#ifdef BDD_NONRECURSIVE
+
+void bdd_mark(int i)
+{
+   BddNode *node;
+   int top = 0;
+
+   for (;;)
+   {
+	 /* Follow the low branches and stack the high ones. The stacked
+	    branches hang off the current path, one per level at most */
+      while (i >= 2)
+      {
+	 node = &bddnodes[i];
+	 if (LEVELp(node) & MARKON  ||  LOWp(node) == -1)
+	    break;
+
+	 LEVELp(node) |= MARKON;
+
+	 if (HIGHp(node) >= 2)
+	    bddmarkstack[top++] = HIGHp(node);
+	 i = LOWp(node);
+      }
+
+      if (top == 0)
+	 return;
+      i = bddmarkstack[--top];
+   }
+}
+
+#else /* BDD_NONRECURSIVE */
+
 void bdd_mark(int i)
 {
    BddNode *node;
@@ -1173,6 +1349,8 @@ void bdd_mark(int i)
    bdd_mark(HIGHp(node));
 }
 
+#endif /* BDD_NONRECURSIVE */
+
 
 void bdd_mark_upto(int i, int level)
 {
@@ -1271,7 +1449,7 @@ int bdd_makenode(unsigned int level, int low, int high)
 
       /* Try to find an existing node of this kind */
    hash = NODEHASH(level, low, high);
-   res = bddnodes[hash].hash;
+   res = BUCKET(hash);
 
    while(res != 0)
    {
@@ -1336,8 +1514,8 @@ int bdd_makenode(unsigned int level, int low, int high)
    HIGHp(node) = high;
    
       /* Insert node */
-   node->next = bddnodes[hash].hash;
-   bddnodes[hash].hash = res;
+   node->next = BUCKET(hash);
+   BUCKET(hash) = res;
 
    return res;
 }
@@ -1346,6 +1524,9 @@ int bdd_makenode(unsigned int level, int low, int high)
 int bdd_noderesize(int doRehash)
 {
    BddNode *newnodes;
+#ifdef BDD_COMPACTNODES
+   int *newhash;
+#endif
    int oldsize = bddnodesize;
    int n;
 
@@ -1361,23 +1542,39 @@ int bdd_noderesize(int doRehash)
       bddnodesize = bddmaxnodesize;
 
    bddnodesize = bdd_prime_lte(bddnodesize);
+
+      /* A cap just above the current size can round back down to it:
+	 nothing to add, and the free list must not be touched */
+   if (bddnodesize <= oldsize)
+   {
+      bddnodesize = oldsize;
+      return -1;
+   }
    
    if (resize_handler != NULL)
       resize_handler(oldsize, bddnodesize);
 
-   newnodes = (BddNode*)realloc(bddnodes, sizeof(BddNode)*bddnodesize);
+   newnodes = (BddNode*)bdd_tablerealloc(bddnodes, sizeof(BddNode)*oldsize,
+					 sizeof(BddNode)*bddnodesize);
    if (newnodes == NULL)
       return bdd_error(BDD_MEMORY);
    bddnodes = newnodes;
+#ifdef BDD_COMPACTNODES
+   newhash = (int*)bdd_tablerealloc(bddhash, sizeof(int)*oldsize,
+				    sizeof(int)*bddnodesize);
+   if (newhash == NULL)
+      return bdd_error(BDD_MEMORY);
+   bddhash = newhash;
+#endif
 
    if (doRehash)
       for (n=0 ; n<oldsize ; n++)
-	 bddnodes[n].hash = 0;
+	 BUCKET(n) = 0;
    
    for (n=oldsize ; n<bddnodesize ; n++)
    {
       bddnodes[n].refcou = 0;
-      bddnodes[n].hash = 0;
+      BUCKET(n) = 0;
       LEVEL(n) = 0;
       LOW(n) = -1;
       bddnodes[n].next = n+1;
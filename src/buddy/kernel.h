@@ -76,6 +76,22 @@
 
 /*=== SEMI-INTERNAL TYPES ==============================================*/
 
+#ifdef BDD_COMPACTNODES
+
+   /* Compact layout: 16 byte nodes (four per cache line in an aligned
+      table) with the unique-table bucket heads kept in the separate
+      array bddhash[] instead of inside the nodes. */
+typedef struct s_BddNode /* Node table entry */
+{
+   unsigned int refcou : 10;
+   unsigned int level  : 22;
+   int low;
+   int high;
+   int next;
+} BddNode;
+
+#else
+
 typedef struct s_BddNode /* Node table entry */
 {
    unsigned int refcou : 10;
@@ -86,6 +102,8 @@ typedef struct s_BddNode /* Node table entry */
    int next;
 } BddNode;
 
+#endif /* BDD_COMPACTNODES */
+
 
 /*=== KERNEL VARIABLES =================================================*/
 
@@ -99,6 +117,9 @@ extern int       bddnodesize;        /* Number of allocated nodes */
 extern int       bddmaxnodesize;     /* Maximum allowed number of nodes */
 extern int       bddmaxnodeincrease; /* Max. # of nodes used to inc. table */
 extern BddNode*  bddnodes;           /* All of the bdd nodes */
+#ifdef BDD_COMPACTNODES
+extern int*      bddhash;            /* Unique table bucket heads */
+#endif
 extern int       bddvarnum;          /* Number of defined BDD variables */
 extern int*      bddrefstack;        /* Internal node reference stack */
 extern int*      bddrefstacktop;     /* Internal node reference stack top */
@@ -142,6 +163,25 @@ extern bddCacheStat bddcachestats;
 #define PAIR(a,b)      ((unsigned int)((((unsigned int)a)+((unsigned int)b))*(((unsigned int)a)+((unsigned int)b)+((unsigned int)1))/((unsigned int)2)+((unsigned int)a)))
 #define TRIPLE(a,b,c)  ((unsigned int)(PAIR((unsigned int)c,PAIR(a,b))))
 
+   /* Operation cache keys. The quadratic PAIR clusters badly when only the
+      low bits are used, so power-of-two caches combine multiplicatively and
+      leave the avalanche to BddCache_lookup. The unique table keeps PAIR. */
+#ifdef BDD_POW2CACHE
+#define CACHEPAIR(a,b)      ((unsigned int)(a)*0x9E3779B1U + (unsigned int)(b))
+#define CACHETRIPLE(a,b,c)  (CACHEPAIR(CACHEPAIR(a,b),c))
+#else
+#define CACHEPAIR(a,b)      PAIR(a,b)
+#define CACHETRIPLE(a,b,c)  TRIPLE(a,b,c)
+#endif
+
+
+   /* Head of unique-table bucket n (also used for the per-level tables
+      during reordering) */
+#ifdef BDD_COMPACTNODES
+#define BUCKET(n) (bddhash[n])
+#else
+#define BUCKET(n) (bddnodes[n].hash)
+#endif
 
    /* Inspection of BDD nodes */
 #define ISCONST(a) ((a) < 2)
@@ -905,11 +905,11 @@ static int mark_roots(void)
 
       /* Make sure the hash field is empty. This saves a loop in the
 	 initial GBC */
-      node->hash = 0;
+      BUCKET(n) = 0;
    }
 
-   bddnodes[0].hash = 0;
-   bddnodes[1].hash = 0;
+   BUCKET(0) = 0;
+   BUCKET(1) = 0;
 
    free(dep);
    return 0;
@@ -938,8 +938,8 @@ static void reorder_gbc(void)
 	 register unsigned int hash;
 	 
 	 hash = NODEHASH(VARp(node), LOWp(node), HIGHp(node));
-	 node->next = bddnodes[hash].hash;
-	 bddnodes[hash].hash = n;
+	 node->next = BUCKET(hash);
+	 BUCKET(hash) = n;
 
       }
       else
@@ -988,7 +988,7 @@ static void reorder_rehashAll(void)
    bddfreepos = 0;
 
    for (n=bddnodesize-1 ; n>=0 ; n--)
-      bddnodes[n].hash = 0;
+      BUCKET(n) = 0;
    
    for (n=bddnodesize-1 ; n>=2 ; n--)
    {
@@ -999,8 +999,8 @@ static void reorder_rehashAll(void)
 	 register unsigned int hash;
 	 
 	 hash = NODEHASH(VARp(node), LOWp(node), HIGHp(node));
-	 node->next = bddnodes[hash].hash;
-	 bddnodes[hash].hash = n;
+	 node->next = BUCKET(hash);
+	 BUCKET(hash) = n;
       }
       else
       {
@@ -1038,7 +1038,7 @@ static int reorder_makenode(int var, int low, int high)
 
       /* Try to find an existing node of this kind */
    hash = NODEHASH(var, low, high);
-   res = bddnodes[hash].hash;
+   res = BUCKET(hash);
       
    while(res != 0)
    {
@@ -1097,8 +1097,8 @@ static int reorder_makenode(int var, int low, int high)
    HIGHp(node) = high;
 
       /* Insert node in hash chain */
-   node->next = bddnodes[hash].hash;
-   bddnodes[hash].hash = res;
+   node->next = BUCKET(hash);
+   BUCKET(hash) = res;
 
       /* Make sure it is reference counted */
    node->refcou = 1;
@@ -1128,8 +1128,8 @@ static int reorder_downSimple(int var0)
    {
       int r;
 
-      r = bddnodes[n + vl0].hash;
-      bddnodes[n + vl0].hash = 0;
+      r = BUCKET(n + vl0);
+      BUCKET(n + vl0) = 0;
 
       while (r != 0)
       {
@@ -1139,8 +1139,8 @@ static int reorder_downSimple(int var0)
 	 if (VAR(LOWp(node)) != var1  &&  VAR(HIGHp(node)) != var1)
 	 {
  	       /* Node does not depend on next var, let it stay in the chain */
-	    node->next = bddnodes[n+vl0].hash;
-	    bddnodes[n+vl0].hash = r;
+	    node->next = BUCKET(n+vl0);
+	    BUCKET(n+vl0) = r;
 	    levels[var0].nodenum++;
 	 }
 	 else
@@ -1219,8 +1219,8 @@ static void reorder_swap(int toBeProcessed, int var0)
       
          /* Rehash the node since it got new childs */
       hash = NODEHASH(VARp(node), LOWp(node), HIGHp(node));
-      node->next = bddnodes[hash].hash;
-      bddnodes[hash].hash = toBeProcessed;
+      node->next = BUCKET(hash);
+      BUCKET(hash) = toBeProcessed;
 
       toBeProcessed = next;
    }
@@ -1241,8 +1241,8 @@ static void reorder_localGbc(int var0)
    for (n=0 ; n<size1 ; n++)
    {
       int hash = n+vl1;
-      int r = bddnodes[hash].hash;
-      bddnodes[hash].hash = 0;
+      int r = BUCKET(hash);
+      BUCKET(hash) = 0;
 
       while (r)
       {
@@ -1251,8 +1251,8 @@ static void reorder_localGbc(int var0)
 
 	 if (node->refcou > 0)
 	 {
-	    node->next = bddnodes[hash].hash;
-	    bddnodes[hash].hash = r;
+	    node->next = BUCKET(hash);
+	    BUCKET(hash) = r;
 	 }
 	 else
 	 {
@@ -1343,8 +1343,8 @@ static void reorder_localGbcResize(int toBeProcessed, int var0)
    for (n=0 ; n<size1 ; n++)
    {
       int hash = n+vl1;
-      int r = bddnodes[hash].hash;
-      bddnodes[hash].hash = 0;
+      int r = BUCKET(hash);
+      BUCKET(hash) = 0;
 
       while (r)
       {
@@ -1388,8 +1388,8 @@ static void reorder_localGbcResize(int toBeProcessed, int var0)
       int next = node->next;
       int hash = NODEHASH(VARp(node), LOWp(node), HIGHp(node));
 	 
-      node->next = bddnodes[hash].hash;
-      bddnodes[hash].hash = toBeProcessed;
+      node->next = BUCKET(hash);
+      BUCKET(hash) = toBeProcessed;
 
       toBeProcessed = next;
    }   
@@ -1420,7 +1420,7 @@ static void sanitycheck(void)
       
       for (n=0 ; n<levels[v].size ; n++)
       {
-	 r = bddnodes[n+levels[v].start].hash;
+	 r = BUCKET(n+levels[v].start);
 	 
 	 while (r)
 	 {
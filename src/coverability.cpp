@@ -0,0 +1,263 @@
+/*
+ * coverability.cpp - Minimal coverability set (Karp–Miller with pruning)
+ *
+ * Follows Valmari & Hansen, "Old and new algorithms for minimal coverability
+ * sets": one set A of ω-markings, kept as an antichain, instead of a tree.
+ *  - a successor covered by an element of A is dropped;
+ *  - otherwise it is accelerated against its ancestors (parent links, kept
+ *    even for markings that left A): an ancestor strictly below it means
+ *    the path between them can be pumped, so the places that grew get ω;
+ *  - the elements of A strictly below it are removed (their successors are
+ *    covered by its successors) and it joins A and the work queue.
+ * At the end A is the minimal coverability set: every reachable marking is
+ * covered by one of its elements and every element is a limit of
+ * reachable markings, so the per-place maxima are the exact bounds.
+ */
+
+#include "coverability.h"
+#include "logger.h"
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <unordered_map>
+
+using namespace std;
+
+namespace {
+
+// Cheap summary of an ω-marking; the 64-bit masks fold place p onto bit p % 64.
+// M <= N needs supp(M) ⊆ supp(N), ω(M) ⊆ ω(N), and when both have the same
+// ω places also sum(M) <= sum(N); most pairs fail one of these.
+struct Signature {
+    uint64_t support = 0;    // Places with a token (or ω)
+    uint64_t omegaMask = 0;  // Places with ω
+    int omegaCount = 0;
+    long long finiteSum = 0;
+
+    explicit Signature(const OmegaMarking &M) {
+        for (size_t p = 0; p < M.size(); ++p) {
+            if (M[p] > 0) support |= 1ULL << (p % 64);
+            if (M[p] == OMEGA) {
+                omegaMask |= 1ULL << (p % 64);
+                ++omegaCount;
+            } else {
+                finiteSum += M[p];
+            }
+        }
+    }
+};
+
+// Signature test for lo <= hi (necessary, not sufficient)
+bool mayBeBelow(const Signature &lo, const Signature &hi) {
+    if ((lo.support & ~hi.support) || (lo.omegaMask & ~hi.omegaMask)) return false;
+    if (lo.omegaCount > hi.omegaCount) return false;
+    return lo.omegaCount < hi.omegaCount || lo.finiteSum <= hi.finiteSum;
+}
+
+struct Node {
+    OmegaMarking m;
+    Signature sig;
+    int parent;   // -1 for M0
+    bool active;  // Still in A
+};
+
+// M <= N componentwise (OMEGA is larger than any count)
+bool leq(const OmegaMarking &M, const OmegaMarking &N) {
+    for (size_t p = 0; p < M.size(); ++p)
+        if (M[p] > N[p]) return false;
+    return true;
+}
+
+uint64_t hashOf(const OmegaMarking &M) {
+    return fnv1a(M.data(), M.size() * sizeof(int));
+}
+
+// Elements of A. An element equal to the query is found through a hash
+// index; that is the common case, most successors were seen before.
+// Otherwise only strictly larger (covers) or smaller (removeBelow) elements
+// matter, and those have more ω places, or the same ω places and a larger
+// (smaller) finite sum. Entries are grouped by (ω count, finite sum) so the
+// group of the query and the groups on the wrong side are never scanned:
+// in a net whose token count is invariant nothing is. Each entry keeps a
+// copy of its signature so a scan only reads the markings that pass it.
+class Antichain {
+public:
+    explicit Antichain(const vector<Node> &nodes) : nodes(nodes) {}
+
+    // Some element >= M
+    bool covers(const OmegaMarking &M, const Signature &sig) const {
+        auto range = byHash.equal_range(hashOf(M));
+        for (auto it = range.first; it != range.second; ++it)
+            if (nodes[it->second].m == M) return true;
+
+        for (auto g = groups.upper_bound(key(sig)); g != groups.end(); ++g) {
+            if (g->first.first == sig.omegaCount && g->first.second <= sig.finiteSum) continue;
+            for (const Entry &e : g->second)
+                if (mayBeBelow(sig, e.sig) && leq(M, nodes[e.node].m)) return true;
+        }
+        return false;
+    }
+
+    // Remove the elements < M (M itself is not in A), appending their nodes to removed
+    void removeBelow(const OmegaMarking &M, const Signature &sig, vector<int> &removed) {
+        for (auto g = groups.begin(); g != groups.end() && g->first < key(sig);) {
+            vector<Entry> &entries = g->second;
+            for (size_t i = 0; i < entries.size();) {
+                const Entry &e = entries[i];
+                if (mayBeBelow(e.sig, sig) && leq(nodes[e.node].m, M)) {
+                    removed.push_back(e.node);
+                    eraseHash(e.node);
+                    entries[i] = entries.back();
+                    entries.pop_back();
+                } else {
+                    ++i;
+                }
+            }
+            g = entries.empty() ? groups.erase(g) : next(g);
+        }
+    }
+
+    void insert(int node) {
+        const Signature &sig = nodes[node].sig;
+        groups[key(sig)].push_back({node, sig});
+        byHash.emplace(hashOf(nodes[node].m), node);
+    }
+
+private:
+    struct Entry {
+        int node;
+        Signature sig;
+    };
+
+    static pair<int, long long> key(const Signature &sig) { return {sig.omegaCount, sig.finiteSum}; }
+
+    void eraseHash(int node) {
+        auto range = byHash.equal_range(hashOf(nodes[node].m));
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == node) {
+                byHash.erase(it);
+                return;
+            }
+        }
+    }
+
+    const vector<Node> &nodes;
+    map<pair<int, long long>, vector<Entry>> groups;  // (omegaCount, finiteSum) -> entries
+    unordered_multimap<uint64_t, int> byHash;
+};
+
+bool enabledOmega(const Model &net, const OmegaMarking &M, int t) {
+    for (size_t p = 0; p < net.places.size(); ++p)
+        if (M[p] < net.Pre[p][t]) return false;
+    return true;
+}
+
+OmegaMarking fireOmega(const Model &net, const OmegaMarking &M, int t) {
+    OmegaMarking next = M;
+    for (size_t p = 0; p < net.places.size(); ++p)
+        if (M[p] != OMEGA) next[p] = M[p] - net.Pre[p][t] + net.Post[p][t];
+    return next;
+}
+
+// Put ω wherever next grew over an ancestor below it, until no ancestor
+// adds more (a new ω can make another ancestor comparable); true if any ω
+// was added
+bool accelerate(const vector<Node> &nodes, int parent, OmegaMarking &next) {
+    bool changed = true, any = false;
+    while (changed) {
+        changed = false;
+        Signature sig(next);
+        for (int a = parent; a != -1; a = nodes[a].parent) {
+            const OmegaMarking &anc = nodes[a].m;
+            if (!mayBeBelow(nodes[a].sig, sig) || !leq(anc, next) || anc == next) continue;
+            for (size_t p = 0; p < next.size(); ++p) {
+                if (anc[p] < next[p] && next[p] != OMEGA) {
+                    next[p] = OMEGA;
+                    changed = any = true;
+                }
+            }
+        }
+    }
+    return any;
+}
+
+} // namespace
+
+CoverResult coverability(const Model &model, const CoverOptions &opts) {
+    CoverResult result;
+    double t0 = getTimeSec();
+    double m0 = getMemoryMB();
+
+    const size_t P = model.places.size();
+    vector<Node> nodes;
+    OmegaMarking start(model.M0.begin(), model.M0.end());
+    nodes.push_back({start, Signature(start), -1, true});
+    Antichain A(nodes);
+    A.insert(0);
+
+    // FIFO: ancestor chains stay as short as the BFS depth, which bounds
+    // the acceleration walk
+    deque<int> work = {0};
+    vector<int> removed;
+    while (!work.empty() && result.complete) {
+        int cur = work.front();
+        work.pop_front();
+
+        OmegaMarking M = nodes[cur].m;
+        for (int t = 0; t < (int)model.transitions.size(); ++t) {
+            // A successor above cur replaced it; that successor covers the rest
+            if (!nodes[cur].active) break;
+            if (!enabledOmega(model, M, t)) continue;
+
+            OmegaMarking next = fireOmega(model, M, t);
+            if (A.covers(next, Signature(next))) continue;
+            if (accelerate(nodes, cur, next) && A.covers(next, Signature(next))) continue;
+            Signature sig(next);
+
+            if (opts.maxNodes && nodes.size() >= opts.maxNodes) {
+                LOG_WARN("[COVER] Node limit reached at " << nodes.size() << " omega-markings");
+                result.complete = false;
+                break;
+            }
+            removed.clear();
+            A.removeBelow(next, sig, removed);
+            for (int r : removed) nodes[r].active = false;
+
+            nodes.push_back({next, sig, cur, true});
+            A.insert((int)nodes.size() - 1);
+            work.push_back((int)nodes.size() - 1);
+        }
+    }
+
+    result.placeBound.assign(P, 0);
+    for (const Node &n : nodes) {
+        if (!n.active) continue;
+        result.mcs.push_back(n.m);
+        for (size_t p = 0; p < P; ++p)
+            result.placeBound[p] = max(result.placeBound[p], n.m[p]);
+    }
+    for (int b : result.placeBound)
+        if (b == OMEGA) result.bounded = false;
+    result.explored = nodes.size();
+
+    result.timeSec = getTimeSec() - t0;
+    double deltaMem = getMemoryMB() - m0;
+    result.memMB = deltaMem < 0 ? getMemoryMB() : deltaMem;
+
+    LOG_INFO("[COVER] " << result.mcs.size() << " omega-markings in the coverability set ("
+             << result.explored << " created), " << (result.bounded ? "bounded" : "unbounded")
+             << (result.complete ? "" : " (partial)"));
+    return result;
+}
+
+string toString(const OmegaMarking &M) {
+    ostringstream oss;
+    oss << "[";
+    for (size_t i = 0; i < M.size(); ++i) {
+        if (M[i] == OMEGA) oss << "w";
+        else oss << M[i];
+        if (i + 1 < M.size()) oss << ",";
+    }
+    oss << "]";
+    return oss.str();
+}
@@ -0,0 +1,36 @@
+#ifndef COVERABILITY_H
+#define COVERABILITY_H
+
+/*
+ * coverability.h - Coverability analysis for unbounded nets (Karp–Miller)
+ * Computes the minimal coverability set with ω-markings; decides
+ * boundedness and per-place bounds where explicit reachability never ends
+ */
+
+#include "utils.h"
+#include <climits>
+
+// ω-marking: token counts, OMEGA = arbitrarily many
+using OmegaMarking = vector<int>;
+const int OMEGA = INT_MAX;
+
+struct CoverOptions {
+    size_t maxNodes = 0;  // >0: stop (partial result) once this many ω-markings were created
+};
+
+struct CoverResult {
+    vector<OmegaMarking> mcs;   // Minimal coverability set (an antichain)
+    vector<int> placeBound;     // Max tokens per place over the reachable set, OMEGA = unbounded
+    bool bounded = true;        // No place is unbounded
+    size_t explored = 0;        // ω-markings created, including ones later subsumed
+    double timeSec = 0.0;
+    double memMB = 0.0;
+    bool complete = true;       // false: maxNodes hit, bounds are lower bounds only
+};
+
+// Minimal coverability set of the net from M0
+CoverResult coverability(const Model &model, const CoverOptions &opts);
+
+string toString(const OmegaMarking &M);
+
+#endif
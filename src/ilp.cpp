@@ -14,6 +14,7 @@
 #include <vector>
 #include <string>
 #include <limits>
+#include <algorithm>
 
 using namespace std;
 
@@ -24,10 +25,143 @@ static bool isDeadlock(const Model& model, const Marking& M) {
     return true;
 }
 
-// Wrapper for BDD reachability check
-static bool isReachableViaBDD(const BddResult& bddResult, const Marking& M, int numPlaces) {
-    if (!bddResult.internalState) return true;  // Fallback if no BDD
-    return bdd_check_reachable(bddResult, M, numPlaces);
+// Wrapper for BDD reachability check, one bitmap entry per marking
+static vector<bool> reachableViaBDD(const BddResult& bddResult, const vector<Marking>& Ms,
+                                    int numPlaces) {
+    if (!bddResult.internalState) return vector<bool>(Ms.size(), true);  // Fallback if no BDD
+    return bdd_check_reachable_batch(bddResult, Ms, numPlaces);
+}
+
+// A marking is encoded as binary digit columns: place p holds
+// sum_j 2^j * x[p][j], j < bits (a single 0/1 column when the net is 1-safe)
+static int markingCol(size_t p, int j, int bits) {
+    return 1 + (int)p * bits + j;
+}
+
+// Add the digit columns; coef[p] is the objective weight of one token in p.
+// Places are capped at bound when the digits could count past it.
+static void addMarkingCols(glp_prob* lp, const Model& model, int bits, int bound,
+                           const vector<double>& coef) {
+    const size_t P = model.places.size();
+    glp_add_cols(lp, (int)P * bits);
+    for (size_t p = 0; p < P; ++p) {
+        for (int j = 0; j < bits; ++j) {
+            int col = markingCol(p, j, bits);
+            string name = "M_" + model.places[p] + (bits > 1 ? "_" + to_string(j) : "");
+            glp_set_col_name(lp, col, name.c_str());
+            glp_set_col_kind(lp, col, GLP_BV);
+            glp_set_obj_coef(lp, col, coef[p] * (double)(1 << j));
+        }
+    }
+    if (bound >= (1 << bits) - 1) return;
+
+    vector<int> ind(bits + 1);
+    vector<double> val(bits + 1);
+    for (size_t p = 0; p < P; ++p) {
+        for (int j = 0; j < bits; ++j) {
+            ind[j + 1] = markingCol(p, j, bits);
+            val[j + 1] = (double)(1 << j);
+        }
+        int row = glp_add_rows(lp, 1);
+        glp_set_mat_row(lp, row, bits, ind.data(), val.data());
+        glp_set_row_bnds(lp, row, GLP_UP, 0.0, (double)bound);
+    }
+}
+
+// Every reachable marking keeps y·M = y·M0, so candidates off these
+// hyperplanes are cut before they reach the BDD check
+static void addInvariantRows(glp_prob* lp, const vector<Invariant>& invariants, int bits) {
+    for (const Invariant& inv : invariants) {
+        vector<int> ind(1);
+        vector<double> val(1);
+        for (const auto& term : inv.terms) {
+            for (int j = 0; j < bits; ++j) {
+                ind.push_back(markingCol(term.first, j, bits));
+                val.push_back((double)term.second * (double)(1 << j));
+            }
+        }
+        int row = glp_add_rows(lp, 1);
+        glp_set_mat_row(lp, row, (int)ind.size() - 1, ind.data(), val.data());
+        glp_set_row_bnds(lp, row, GLP_FX, (double)inv.value, (double)inv.value);
+    }
+}
+
+static Marking readMarking(glp_prob* lp, size_t P, int bits) {
+    Marking M(P);
+    for (size_t p = 0; p < P; ++p) {
+        int tokens = 0;
+        for (int j = 0; j < bits; ++j)
+            if (glp_mip_col_val(lp, markingCol(p, j, bits)) > 0.5) tokens |= 1 << j;
+        M[p] = (Token)tokens;
+    }
+    return M;
+}
+
+// Exclude the exact digit assignment of cand:
+// sum_{x: c_x=1} x - sum_{x: c_x=0} x <= ones - 1
+static void excludeMarking(glp_prob* lp, const Marking& cand, int bits) {
+    const int n = (int)cand.size() * bits;
+    vector<int> ind(n + 1);
+    vector<double> val(n + 1);
+    int ones = 0;
+    for (size_t p = 0; p < cand.size(); ++p) {
+        for (int j = 0; j < bits; ++j) {
+            int col = markingCol(p, j, bits);
+            bool set = (cand[p] >> j) & 1;
+            ind[col] = col;
+            val[col] = set ? 1.0 : -1.0;
+            if (set) ++ones;
+        }
+    }
+    int row = glp_add_rows(lp, 1);
+    glp_set_mat_row(lp, row, n, ind.data(), val.data());
+    glp_set_row_bnds(lp, row, GLP_UP, 0.0, (double)(ones - 1));
+}
+
+// Candidates are checked against Reached in rounds: the MIP is solved up to
+// `want` times, each candidate excluded so that the next solve returns
+// another one, and the round goes through a single batch check. Candidates
+// come out in objective order, so the first accepted one is still the one a
+// solve-and-check loop would have found. The round size doubles while every
+// candidate is rejected, so a net whose first candidate is accepted still
+// costs one solve.
+static const int MAX_ROUND = 64;
+
+struct CandidateRound {
+    vector<Marking> markings;
+    vector<double> objs;
+    bool exhausted = false;  // The MIP has no solution left
+};
+
+// excludeEmpty = false leaves the all-zero candidate in the MIP and ends the round at it
+static CandidateRound drawCandidates(glp_prob* lp, size_t P, int bits, int want,
+                                     bool excludeEmpty, bool verbose) {
+    CandidateRound round;
+    while ((int)round.markings.size() < want) {
+        glp_simplex(lp, nullptr);
+        glp_intopt(lp, nullptr);
+
+        int status = glp_mip_status(lp);
+        if (!(status == GLP_OPT || status == GLP_FEAS)) {
+            if (verbose)
+                cout << "[ILP] No feasible candidate left (status=" << status << ")\n";
+            round.exhausted = true;
+            break;
+        }
+
+        Marking cand = readMarking(lp, P, bits);
+        double obj = glp_mip_obj_val(lp);
+        if (verbose)
+            cout << "[ILP] Candidate: " << toString(cand) << " (obj=" << obj << ")\n";
+        round.markings.push_back(cand);
+        round.objs.push_back(obj);
+
+        bool empty = true;
+        for (size_t p = 0; p < P; ++p) if (cand[p]) empty = false;
+        if (empty && !excludeEmpty) break;
+        excludeMarking(lp, cand, bits);
+    }
+    return round;
 }
 
 // Task 4: Find reachable deadlock marking using ILP + BDD
@@ -70,123 +204,121 @@ static IlpResult solveDeadlockILP(const Model& model,
         // **Set objective to MINIMIZE sum_p M_p** so solver prefers minimal-cardinality deadlocks
         glp_set_obj_dir(lp, GLP_MIN);
 
-        // Columns: M[p] as binary (1-safe)
-        glp_add_cols(lp, (int)P);
-        vector<string> colNames(P);
-        for (size_t p = 0; p < P; ++p) {
-            colNames[p] = "M_" + model.places[p];
-            glp_set_col_name(lp, (int)p + 1, colNames[p].c_str());
-            glp_set_col_kind(lp, (int)p + 1, GLP_BV);
-            // objective coefficient = 1 (minimize number of tokens)
-            glp_set_obj_coef(lp, (int)p + 1, 1.0);
-        }
+        // Columns: digits of M[p] (one binary per place when 1-safe)
+        const int bound = max(1, bddResult.tokenBound);
+        const int bits = bitsForBound(bound);
+        // objective coefficient = 1 per token (minimize number of tokens)
+        addMarkingCols(lp, model, bits, bound, vector<double>(P, 1.0));
+        addInvariantRows(lp, options.invariants, bits);
+
+        if (bits == 1) {
+            // Rows: for each transition, require insufficient tokens (no transition enabled)
+            for (int t = 0; t < (int)T; ++t) {
+                int totalPre = 0;
+                for (size_t p = 0; p < P; ++p) totalPre += model.Pre[p][t];
+
+                int nz = 0;
+                for (size_t p = 0; p < P; ++p) if (model.Pre[p][t] > 0) ++nz;
 
-        // Rows: for each transition, require insufficient tokens (no transition enabled)
-        glp_add_rows(lp, (int)T);
-        for (int t = 0; t < (int)T; ++t) {
-            int totalPre = 0;
-            for (size_t p = 0; p < P; ++p) totalPre += model.Pre[p][t];
-
-            int nz = 0;
-            for (size_t p = 0; p < P; ++p) if (model.Pre[p][t] > 0) ++nz;
-
-            vector<int> ind(nz + 1);
-            vector<double> val(nz + 1);
-            int idx = 0;
-            for (size_t p = 0; p < P; ++p) {
-                if (model.Pre[p][t] > 0) {
-                    ++idx;
-                    ind[idx] = (int)p + 1;
-                    val[idx] = (double)model.Pre[p][t];
+                vector<int> ind(nz + 1);
+                vector<double> val(nz + 1);
+                int idx = 0;
+                for (size_t p = 0; p < P; ++p) {
+                    if (model.Pre[p][t] > 0) {
+                        ++idx;
+                        ind[idx] = (int)p + 1;
+                        val[idx] = (double)model.Pre[p][t];
+                    }
                 }
-            }
 
-            glp_set_mat_row(lp, t + 1, nz, ind.data(), val.data());
-            glp_set_row_bnds(lp, t + 1, GLP_UP, 0.0, (double)(totalPre - 1));
+                int row = glp_add_rows(lp, 1);
+                glp_set_mat_row(lp, row, nz, ind.data(), val.data());
+                glp_set_row_bnds(lp, row, GLP_UP, 0.0, (double)(totalPre - 1));
+            }
+        } else {
+            // k-bounded: t is disabled iff some input place p has M_p <= Pre - 1.
+            // Binary y_tp selects that place:
+            //   M_p + U*y_tp <= Pre - 1 + U  (U = bound - (Pre - 1)),  sum_p y_tp >= 1
+            for (int t = 0; t < (int)T; ++t) {
+                vector<int> inputs;
+                bool neverEnabled = false;
+                for (size_t p = 0; p < P; ++p) {
+                    if (model.Pre[p][t] > bound) neverEnabled = true;
+                    if (model.Pre[p][t] > 0) inputs.push_back((int)p);
+                }
+                if (neverEnabled) continue;
+
+                int firstY = glp_add_cols(lp, (int)inputs.size());
+                vector<int> yInd(inputs.size() + 1);
+                vector<double> yVal(inputs.size() + 1, 1.0);
+                for (size_t k = 0; k < inputs.size(); ++k) {
+                    int p = inputs[k];
+                    int y = firstY + (int)k;
+                    glp_set_col_kind(lp, y, GLP_BV);
+                    yInd[k + 1] = y;
+
+                    double slack = model.Pre[p][t] - 1;
+                    double U = bound - slack;
+                    vector<int> ind(bits + 2);
+                    vector<double> val(bits + 2);
+                    for (int j = 0; j < bits; ++j) {
+                        ind[j + 1] = markingCol(p, j, bits);
+                        val[j + 1] = (double)(1 << j);
+                    }
+                    ind[bits + 1] = y;
+                    val[bits + 1] = U;
+                    int row = glp_add_rows(lp, 1);
+                    glp_set_mat_row(lp, row, bits + 1, ind.data(), val.data());
+                    glp_set_row_bnds(lp, row, GLP_UP, 0.0, slack + U);
+                }
+                int row = glp_add_rows(lp, 1);
+                glp_set_mat_row(lp, row, (int)inputs.size(), yInd.data(), yVal.data());
+                glp_set_row_bnds(lp, row, GLP_LO, 1.0, 0.0);
+            }
         }
 
-        // We'll iteratively query GLPK: if candidate is not reachable (via BDD), add a cut to exclude it and repeat
+        // We'll iteratively query GLPK: candidates that are not reachable (via BDD)
+        // or not dead are cut off and the search goes on
         glp_term_out(GLP_OFF);  // silence GLPK
 
         int cuts = 0;
         const int maxCuts = options.maxCuts > 0 ? options.maxCuts : 10000;
-
-        while (true) {
-            // solve MIP
-            glp_simplex(lp, nullptr);
-            glp_intopt(lp, nullptr);
-
-            int status = glp_mip_status(lp);
-            if (!(status == GLP_OPT || status == GLP_FEAS)) {
-                if (options.verbose)
-                    cout << "[ILP] No feasible deadlock marking (status=" << status << ")\n";
-                break;
-            }
-
-            Marking cand(P);
-            for (size_t p = 0; p < P; ++p) {
-                double v = glp_mip_col_val(lp, (int)p + 1);
-                cand[p] = (Token)(v > 0.5 ? 1 : 0);
-            }
-
-            if (options.verbose)
-                cout << "[ILP] Candidate dead marking: " << toString(cand) << endl;
-
-            bool reachable = isReachableViaBDD(bddResult, cand, (int)P);
-            bool isDead = isDeadlock(model, cand);
-
-            if (options.verbose) {
-                cout << "[ILP]   -> Reachable? " << (reachable ? "YES" : "NO") << endl;
-                cout << "[ILP]   -> Is dead? " << (isDead ? "YES" : "NO") << endl;
-            }
-
-            if (reachable && isDead) {
-                result.hasDeadlock = true;
-                result.isReachable = true;
-                result.deadlockMarking = cand;
-                break;
-            }
-
-            // Exclude this candidate and continue search (exclude exact assignment only)
-            int k = 0;
-            for (size_t p = 0; p < P; ++p) if (cand[p]) ++k;
-
-            if (k == 0) {
-                // exclude zero vector by forcing at least one 1: sum_p M_p >= 1
-                vector<int> ind((int)P + 1);
-                vector<double> val((int)P + 1);
-                for (size_t p = 0; p < P; ++p) {
-                    ind[(int)p + 1] = (int)p + 1;
-                    val[(int)p + 1] = 1.0;
+        int want = 1;
+        bool done = false;
+
+        while (!done) {
+            // Exact-assignment cuts; for the zero vector this forces at least one token
+            CandidateRound round = drawCandidates(lp, P, bits, min(want, maxCuts - cuts + 1),
+                                                  true, options.verbose);
+            vector<bool> reachable = reachableViaBDD(bddResult, round.markings, (int)P);
+
+            for (size_t i = 0; i < round.markings.size() && !done; ++i) {
+                const Marking& cand = round.markings[i];
+                bool isDead = isDeadlock(model, cand);
+
+                if (options.verbose) {
+                    cout << "[ILP] " << toString(cand) << " -> Reachable? "
+                         << (reachable[i] ? "YES" : "NO") << ", Is dead? "
+                         << (isDead ? "YES" : "NO") << endl;
                 }
-                glp_add_rows(lp, 1);
-                int row = glp_get_num_rows(lp);
-                glp_set_mat_row(lp, row, (int)P, ind.data(), val.data());
-                glp_set_row_bnds(lp, row, GLP_LO, 1.0, 0.0);
-                if (options.verbose) cout << "[ILP] Excluding zero-candidate (require >=1 token)\n";
-            } else {
-                // Exclude exact assignment c:
-                // sum_{p: c_p=1} M_p - sum_{p: c_p=0} M_p <= k - 1
-                vector<int> ind((int)P + 1);
-                vector<double> val((int)P + 1);
-                int idx = 0;
-                for (size_t p = 0; p < P; ++p) {
-                    ++idx;
-                    ind[idx] = (int)p + 1;
-                    val[idx] = (cand[p] ? 1.0 : -1.0);
+
+                if (reachable[i] && isDead) {
+                    result.hasDeadlock = true;
+                    result.isReachable = true;
+                    result.deadlockMarking = cand;
+                    done = true;
+                    break;
                 }
-                glp_add_rows(lp, 1);
-                int row = glp_get_num_rows(lp);
-                glp_set_mat_row(lp, row, (int)P, ind.data(), val.data());
-                glp_set_row_bnds(lp, row, GLP_UP, 0.0, (double)(k - 1));
-                if (options.verbose) cout << "[ILP] Excluding exact candidate (cut #" << cuts+1 << ")\n";
-            }
 
-            ++cuts;
-            if (cuts > maxCuts) {
-                if (options.verbose) cout << "[ILP] Max cuts (" << maxCuts << ") reached.\n";
-                break;
+                ++cuts;
+                if (options.verbose) cout << "[ILP] Excluding exact candidate (cut #" << cuts << ")\n";
+                if (cuts > maxCuts) {
+                    if (options.verbose) cout << "[ILP] Max cuts (" << maxCuts << ") reached.\n";
+                    done = true;
+                }
             }
+            if (round.exhausted) done = true;
+            want = min(want * 2, MAX_ROUND);
         }
 
     } catch (const exception& e) {
@@ -229,14 +361,11 @@ static IlpResult solveOptimizationILP(const Model& model,
         glp_set_prob_name(lp, "MarkingOptimization");
         glp_set_obj_dir(lp, GLP_MAX);
 
-        glp_add_cols(lp, (int)P);
-        vector<string> colNames(P);
-        for (size_t p = 0; p < P; ++p) {
-            colNames[p] = "M_" + model.places[p];
-            glp_set_col_name(lp, (int)p + 1, colNames[p].c_str());
-            glp_set_col_kind(lp, (int)p + 1, GLP_BV);
-            glp_set_obj_coef(lp, (int)p + 1, (double)options.weights[p]);
-        }
+        const int bound = max(1, bddResult.tokenBound);
+        const int bits = bitsForBound(bound);
+        addMarkingCols(lp, model, bits, bound,
+                       vector<double>(options.weights.begin(), options.weights.end()));
+        addInvariantRows(lp, options.invariants, bits);
 
         // For optimization we don't add deadlock constraints here (seek reachable marking maximizing c^T M)
         const int maxCuts = options.maxCuts > 0 ? options.maxCuts : 10000;
@@ -248,70 +377,46 @@ static IlpResult solveOptimizationILP(const Model& model,
         glp_term_out(GLP_OFF);  // Tắt output của GLPK
 
         // Note: We iterate because GLPK might return non-reachable candidate; exclude them progressively
-        while (true) {
-            glp_simplex(lp, nullptr);
-            glp_intopt(lp, nullptr);
-            int status = glp_mip_status(lp);
-
-            if (!(status == GLP_OPT || status == GLP_FEAS)) {
-                if (options.verbose) 
-                    cout << "[ILP] No feasible solutions left (status=" << status << ").\n";
-                break;
-            }
-
-            Marking cand(P);
-            for (size_t p = 0; p < P; ++p) {
-                double v = glp_mip_col_val(lp, (int)p + 1);
-                cand[p] = (Token)(v > 0.5 ? 1 : 0);
-            }
-            double obj = glp_mip_obj_val(lp);
-
-            if (options.verbose) 
-                cout << "[ILP] Candidate: " << toString(cand) << " (obj=" << obj << ")\n";
-
-            if (isReachableViaBDD(bddResult, cand, (int)P)) {
-                found = true;
-                bestM = cand;
-                bestObj = obj;
-                if (options.verbose) 
-                    cout << "[ILP] Candidate is reachable. Accepting.\n";
-                break;
-            }
-
-            // Add cutting plane to exclude this candidate (exact assignment)
-            int k = 0;
-            for (size_t p = 0; p < P; ++p) if (cand[p]) ++k;
-            if (k == 0) {
-                if (options.verbose) 
-                    cout << "[ILP] Empty candidate not reachable -> stop.\n";
-                break;
-            }
-
-            // build exact-exclude constraint:
-            // sum_{p: c_p=1} M_p - sum_{p: c_p=0} M_p <= k - 1
-            vector<int> ind((int)P + 1);
-            vector<double> val((int)P + 1);
-            int idx = 0;
-            for (size_t p = 0; p < P; ++p) {
-                ++idx;
-                ind[idx] = (int)p + 1;
-                val[idx] = (cand[p] ? 1.0 : -1.0);
-            }
-
-            glp_add_rows(lp, 1);
-            int row = glp_get_num_rows(lp);
-            glp_set_mat_row(lp, row, (int)P, ind.data(), val.data());
-            glp_set_row_bnds(lp, row, GLP_UP, 0.0, (double)(k - 1));
+        int want = 1;
+        bool done = false;
+        while (!done) {
+            // The empty candidate is not cut off: if it is unreachable the search stops
+            CandidateRound round = drawCandidates(lp, P, bits, min(want, maxCuts - cuts + 1),
+                                                  false, options.verbose);
+            vector<bool> reachable = reachableViaBDD(bddResult, round.markings, (int)P);
+
+            for (size_t i = 0; i < round.markings.size() && !done; ++i) {
+                const Marking& cand = round.markings[i];
+                if (reachable[i]) {
+                    found = true;
+                    bestM = cand;
+                    bestObj = round.objs[i];
+                    if (options.verbose)
+                        cout << "[ILP] Candidate " << toString(cand) << " is reachable. Accepting.\n";
+                    done = true;
+                    break;
+                }
 
-            ++cuts;
-            if (options.verbose) 
-                cout << "[ILP] Excluding exact candidate (cut #" << cuts << ")\n";
+                int k = 0;
+                for (size_t p = 0; p < P; ++p) if (cand[p]) ++k;
+                if (k == 0) {
+                    if (options.verbose)
+                        cout << "[ILP] Empty candidate not reachable -> stop.\n";
+                    done = true;
+                    break;
+                }
 
-            if (cuts > maxCuts) {
-                if (options.verbose) 
-                    cout << "[ILP] Max cuts (" << maxCuts << ") reached.\n";
-                break;
+                ++cuts;
+                if (options.verbose)
+                    cout << "[ILP] Excluding exact candidate (cut #" << cuts << ")\n";
+                if (cuts > maxCuts) {
+                    if (options.verbose)
+                        cout << "[ILP] Max cuts (" << maxCuts << ") reached.\n";
+                    done = true;
+                }
             }
+            if (round.exhausted) done = true;
+            want = min(want * 2, MAX_ROUND);
         }
 
         if (found) {
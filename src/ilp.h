@@ -8,6 +8,7 @@
  */
 
 #include "utils.h"
+#include "invariants.h"
 #include <vector>
 
 enum class IlpMode {
@@ -20,6 +21,7 @@ struct IlpOptions {
     std::vector<int> weights;  // Coefficients c for optimization
     bool verbose = false;
     int maxCuts = 10000;       // Max cutting-plane iterations
+    std::vector<Invariant> invariants;  // P-invariants: y·M = y·M0 rows prune unreachable candidates
 };
 
 // Solve ILP with BDD reachability checking
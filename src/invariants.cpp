@@ -0,0 +1,357 @@
+/*
+ * invariants.cpp - Farkas algorithm for P-/T-semiflows
+ *
+ * Rows start as [A(i,·) | e_i] for the matrix A (C for P-invariants, C^T
+ * for T-invariants). Each step eliminates one column j: rows with
+ * A(·,j) = 0 stay, and every pair of rows with opposite signs in column j
+ * is combined positively so that the entry cancels. Rows are sparse, kept
+ * in lowest terms, and pruned after each step: a row whose support (the
+ * e_i part) contains the support of another row is a positive combination
+ * of minimal ones and is dropped. What is left when all columns are gone
+ * are the minimal-support semiflows.
+ * Columns are taken cheapest first (fewest positive x negative pairs),
+ * which keeps the intermediate table small on the usual nets.
+ */
+
+#include "invariants.h"
+#include "logger.h"
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <numeric>
+
+using namespace std;
+
+namespace {
+
+using SparseRow = vector<pair<int, long long>>;  // (column, nonzero value), by column
+
+struct Row {
+    SparseRow a;               // Entries of the columns not yet eliminated
+    SparseRow y;               // The combination of original rows (the candidate semiflow)
+    vector<uint64_t> support;  // Bitset of the indices in y
+};
+
+long long entry(const SparseRow &r, int col) {
+    auto it = lower_bound(r.begin(), r.end(), make_pair(col, LLONG_MIN));
+    return (it != r.end() && it->first == col) ? it->second : 0;
+}
+
+// fa*a + fb*b without the zero entries; overflow is set (and the row is
+// unusable) when an entry leaves long long. LLONG_MIN counts as overflow
+// too: normalize and the factors negate entries.
+SparseRow combine(const SparseRow &a, long long fa, const SparseRow &b, long long fb, bool &overflow) {
+    SparseRow out;
+    out.reserve(a.size() + b.size());
+    size_t i = 0, j = 0;
+    while (i < a.size() || j < b.size()) {
+        int col;
+        long long v;
+        bool bad;
+        if (j == b.size() || (i < a.size() && a[i].first < b[j].first)) {
+            col = a[i].first;
+            bad = __builtin_mul_overflow(fa, a[i++].second, &v);
+        } else if (i == a.size() || b[j].first < a[i].first) {
+            col = b[j].first;
+            bad = __builtin_mul_overflow(fb, b[j++].second, &v);
+        } else {
+            col = a[i].first;
+            long long w;
+            bad = __builtin_mul_overflow(fa, a[i++].second, &v) ||
+                  __builtin_mul_overflow(fb, b[j++].second, &w) || __builtin_add_overflow(v, w, &v);
+        }
+        if (bad || v == LLONG_MIN) {
+            overflow = true;
+            return out;
+        }
+        if (v != 0) out.push_back({col, v});
+    }
+    return out;
+}
+
+void normalize(Row &r) {
+    long long g = 0;
+    for (const auto &e : r.a) g = gcd(g, llabs(e.second));
+    for (const auto &e : r.y) g = gcd(g, llabs(e.second));
+    if (g <= 1) return;
+    for (auto &e : r.a) e.second /= g;
+    for (auto &e : r.y) e.second /= g;
+}
+
+bool subset(const vector<uint64_t> &a, const vector<uint64_t> &b) {
+    for (size_t w = 0; w < a.size(); ++w)
+        if (a[w] & ~b[w]) return false;
+    return true;
+}
+
+// Drop rows whose support strictly contains another row's, and repeated rows
+void pruneRedundant(vector<Row> &rows) {
+    vector<bool> drop(rows.size(), false);
+    for (size_t i = 0; i < rows.size(); ++i) {
+        for (size_t k = 0; k < rows.size() && !drop[i]; ++k) {
+            if (k == i || drop[k] || !subset(rows[k].support, rows[i].support)) continue;
+            if (!subset(rows[i].support, rows[k].support)) drop[i] = true;
+            else if (k < i && rows[k].y == rows[i].y) drop[i] = true;
+        }
+    }
+    size_t n = 0;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        if (drop[i]) continue;
+        if (n != i) rows[n] = move(rows[i]);
+        ++n;
+    }
+    rows.resize(n);
+}
+
+// Semiflows y >= 0 with y·A = 0, A given as sparse rows over numCols columns
+InvariantResult farkas(const vector<SparseRow> &A, int numCols, const InvariantOptions &opts) {
+    InvariantResult result;
+    double t0 = getTimeSec();
+    const size_t n = A.size();
+    const size_t words = (n + 63) / 64;
+
+    vector<Row> rows(n);
+    for (size_t i = 0; i < n; ++i) {
+        rows[i].a = A[i];
+        rows[i].y = {{(int)i, 1}};
+        rows[i].support.assign(words, 0);
+        rows[i].support[i / 64] |= 1ULL << (i % 64);
+    }
+
+    vector<bool> done(numCols, false);
+    size_t dropped = 0;  // Rows lost to overflow: the result is then incomplete
+    for (int step = 0; step < numCols; ++step) {
+        // Cheapest column: fewest (positive, negative) pairs
+        vector<long long> pos(numCols, 0), neg(numCols, 0);
+        for (const Row &r : rows)
+            for (const auto &e : r.a) (e.second > 0 ? pos : neg)[e.first]++;
+        int col = -1;
+        for (int j = 0; j < numCols; ++j)
+            if (!done[j] && (col < 0 || pos[j] * neg[j] < pos[col] * neg[col])) col = j;
+        done[col] = true;
+
+        vector<Row> next;
+        vector<size_t> plus, minus;
+        for (size_t i = 0; i < rows.size(); ++i) {
+            long long v = entry(rows[i].a, col);
+            if (v == 0) next.push_back(rows[i]);
+            else (v > 0 ? plus : minus).push_back(i);
+        }
+        for (size_t i : plus) {
+            for (size_t k : minus) {
+                const Row &p = rows[i], &m = rows[k];
+                long long fp = -entry(m.a, col), fm = entry(p.a, col);
+                Row r;
+                bool overflow = false;
+                r.a = combine(p.a, fp, m.a, fm, overflow);
+                r.y = combine(p.y, fp, m.y, fm, overflow);
+                if (overflow) {
+                    // Dropping a row only loses the semiflows built from it
+                    ++dropped;
+                    continue;
+                }
+                r.support.resize(words);
+                for (size_t w = 0; w < words; ++w) r.support[w] = p.support[w] | m.support[w];
+                normalize(r);
+                next.push_back(move(r));
+            }
+        }
+        pruneRedundant(next);
+        rows = move(next);
+
+        if (opts.maxRows && rows.size() > opts.maxRows) {
+            LOG_WARN("[INVARIANTS] Farkas table exceeds " << opts.maxRows << " rows, giving up");
+            result.complete = false;
+            result.timeSec = getTimeSec() - t0;
+            return result;
+        }
+    }
+
+    for (const Row &r : rows) {
+        Invariant inv;
+        for (const auto &e : r.y) {
+            if (e.second > INT_MAX) break;
+            inv.terms.push_back({e.first, (int)e.second});
+        }
+        if (inv.terms.size() < r.y.size()) {
+            ++dropped;
+            continue;
+        }
+        result.invariants.push_back(move(inv));
+    }
+    if (dropped > 0) {
+        LOG_WARN("[INVARIANTS] " << dropped << " Farkas rows dropped (coefficients too large), "
+                 << "the invariant list is incomplete");
+        result.complete = false;
+    }
+    result.timeSec = getTimeSec() - t0;
+    return result;
+}
+
+} // namespace
+
+InvariantResult computePInvariants(const Model &model, const InvariantOptions &opts) {
+    const size_t P = model.places.size(), T = model.transitions.size();
+    vector<SparseRow> A(P);
+    for (size_t p = 0; p < P; ++p)
+        for (size_t t = 0; t < T; ++t)
+            if (model.Post[p][t] != model.Pre[p][t]) A[p].push_back({(int)t, model.Post[p][t] - model.Pre[p][t]});
+
+    InvariantResult res = farkas(A, (int)T, opts);
+    for (Invariant &inv : res.invariants)
+        for (const auto &term : inv.terms) inv.value += (long long)term.second * model.M0[term.first];
+    LOG_INFO("[INVARIANTS] " << res.invariants.size() << " P-invariants (" << res.timeSec << "s)");
+    return res;
+}
+
+InvariantResult computeTInvariants(const Model &model, const InvariantOptions &opts) {
+    const size_t P = model.places.size(), T = model.transitions.size();
+    vector<SparseRow> A(T);
+    for (size_t t = 0; t < T; ++t)
+        for (size_t p = 0; p < P; ++p)
+            if (model.Post[p][t] != model.Pre[p][t]) A[t].push_back({(int)p, model.Post[p][t] - model.Pre[p][t]});
+
+    InvariantResult res = farkas(A, (int)P, opts);
+    LOG_INFO("[INVARIANTS] " << res.invariants.size() << " T-invariants (" << res.timeSec << "s)");
+    return res;
+}
+
+bool coveredByInvariants(const vector<Invariant> &pInvariants, size_t numPlaces) {
+    vector<bool> covered(numPlaces, false);
+    for (const Invariant &inv : pInvariants)
+        for (const auto &term : inv.terms) covered[term.first] = true;
+    return find(covered.begin(), covered.end(), false) == covered.end();
+}
+
+// Fraction-free Gauss-Jordan on the rows [y | y·M0]: each independent row
+// gets a pivot place, eliminated from every other row, so a pivot depends
+// on non-pivot places only. Pivots with the smallest coefficient are taken
+// first; a row whose elimination would grow past 2^40 is left out.
+PlaceBasis::PlaceBasis(size_t numPlaces, const vector<Invariant> &pInvariants) : numPlaces(numPlaces) {
+    const long long LIMIT = 1LL << 40;
+    vector<vector<long long>> pivotRows;  // numPlaces coefficients + value
+    vector<int> pivots;
+    vector<bool> isPivot(numPlaces, false);
+
+    auto reduce = [](vector<long long> &row) {
+        long long g = 0;
+        for (long long v : row) g = gcd(g, llabs(v));
+        if (g > 1)
+            for (long long &v : row) v /= g;
+    };
+    // row -= (row[c] / pivot[c]) * pivot, scaled to stay integral; false on overflow
+    auto eliminate = [&](vector<long long> &row, const vector<long long> &pivot, int c) {
+        long long a = pivot[c], b = row[c];
+        if (b == 0) return true;
+        for (size_t k = 0; k <= numPlaces; ++k) {
+            long long v;
+            if (__builtin_mul_overflow(row[k], a, &v)) return false;
+            long long w;
+            if (__builtin_mul_overflow(pivot[k], b, &w) || __builtin_sub_overflow(v, w, &v)) return false;
+            if (llabs(v) > LIMIT) return false;
+            row[k] = v;
+        }
+        reduce(row);
+        return true;
+    };
+
+    for (const Invariant &inv : pInvariants) {
+        vector<long long> row(numPlaces + 1, 0);
+        for (const auto &term : inv.terms) row[term.first] = term.second;
+        row[numPlaces] = inv.value;
+        bool ok = true;
+        for (size_t i = 0; i < pivots.size() && ok; ++i) ok = eliminate(row, pivotRows[i], pivots[i]);
+        if (!ok) continue;
+
+        int c = -1;
+        for (size_t p = 0; p < numPlaces; ++p)
+            if (row[p] != 0 && (c < 0 || llabs(row[p]) < llabs(row[c]))) c = (int)p;
+        if (c < 0) continue;  // Combination of the earlier invariants
+        if (row[c] < 0)
+            for (long long &v : row) v = -v;
+
+        vector<vector<long long>> updated = pivotRows;
+        for (size_t i = 0; i < updated.size() && ok; ++i) {
+            ok = eliminate(updated[i], row, c);
+            if (updated[i][pivots[i]] < 0)  // Keep the pivot coefficients positive
+                for (long long &v : updated[i]) v = -v;
+        }
+        if (!ok) continue;
+        pivotRows = move(updated);
+        pivotRows.push_back(move(row));
+        pivots.push_back(c);
+        isPivot[c] = true;
+    }
+
+    vector<int> position(numPlaces, -1);
+    for (size_t p = 0; p < numPlaces; ++p) {
+        if (isPivot[p]) continue;
+        position[p] = (int)basis.size();
+        basis.push_back((int)p);
+    }
+    for (size_t i = 0; i < pivots.size(); ++i) {
+        ImpliedPlace rule{pivots[i], pivotRows[i][pivots[i]], pivotRows[i][numPlaces], {}};
+        for (size_t p = 0; p < numPlaces; ++p)
+            if (!isPivot[p] && pivotRows[i][p] != 0) rule.terms.push_back({position[p], pivotRows[i][p]});
+        rules.push_back(move(rule));
+    }
+}
+
+Marking PlaceBasis::compress(Marking M) const {
+    // basis is ascending, so the stored places move down in place
+    for (size_t i = 0; i < basis.size() && !rules.empty(); ++i) M[i] = M[basis[i]];
+    if (!rules.empty()) M.resize(basis.size());
+    return M;
+}
+
+Marking PlaceBasis::expand(const Marking &B) const {
+    if (rules.empty()) return B;
+    Marking M(numPlaces);
+    for (size_t i = 0; i < basis.size(); ++i) M[basis[i]] = B[i];
+    for (const ImpliedPlace &rule : rules) {
+        long long rest = rule.value;
+        for (const auto &term : rule.terms) rest -= term.second * B[term.first];
+        M[rule.place] = (Token)(rest / rule.div);
+    }
+    return M;
+}
+
+vector<int> invariantPlaceOrder(const vector<Invariant> &pInvariants, size_t numPlaces) {
+    vector<int> order;
+    vector<bool> placed(numPlaces, false), used(pInvariants.size(), false);
+    for (size_t step = 0; step < pInvariants.size(); ++step) {
+        // Most places already placed, then smallest support (state machines before sums of them)
+        int best = -1;
+        size_t bestShared = 0;
+        for (size_t i = 0; i < pInvariants.size(); ++i) {
+            if (used[i]) continue;
+            size_t shared = 0;
+            for (const auto &term : pInvariants[i].terms) shared += placed[term.first];
+            if (best < 0 || shared > bestShared ||
+                (shared == bestShared && pInvariants[i].terms.size() < pInvariants[best].terms.size())) {
+                best = (int)i;
+                bestShared = shared;
+            }
+        }
+        used[best] = true;
+        for (const auto &term : pInvariants[best].terms) {
+            if (placed[term.first]) continue;
+            placed[term.first] = true;
+            order.push_back(term.first);
+        }
+    }
+    for (size_t p = 0; p < numPlaces; ++p)
+        if (!placed[p]) order.push_back((int)p);
+    return order;
+}
+
+string toString(const Invariant &inv, const vector<string> &names, bool withValue) {
+    ostringstream oss;
+    for (size_t i = 0; i < inv.terms.size(); ++i) {
+        if (i) oss << " + ";
+        if (inv.terms[i].second != 1) oss << inv.terms[i].second << "*";
+        oss << names[inv.terms[i].first];
+    }
+    if (withValue) oss << " = " << inv.value;
+    return oss.str();
+}
@@ -0,0 +1,70 @@
+#ifndef INVARIANTS_H
+#define INVARIANTS_H
+
+/*
+ * invariants.h - P- and T-invariants (semiflows) of the incidence matrix
+ * C = Post - Pre, computed with the Farkas algorithm on sparse integer rows
+ *  - P-invariant y >= 0, y·C = 0: y·M = y·M0 for every reachable M
+ *  - T-invariant x >= 0, C·x = 0: firing counts x reproduce the marking
+ */
+
+#include "utils.h"
+
+struct Invariant {
+    vector<pair<int, int>> terms;  // (place or transition index, coefficient > 0), by index
+    long long value = 0;           // P-invariants: y·M0, the weighted token count kept by every firing
+};
+
+struct InvariantOptions {
+    size_t maxRows = 10000;  // Give up (complete = false) when the Farkas table grows past this
+};
+
+struct InvariantResult {
+    vector<Invariant> invariants;  // Minimal-support semiflows, one per support
+    bool complete = true;          // false: maxRows hit (the list is empty) or rows dropped on
+                                   // coefficient overflow (the listed ones are still semiflows)
+    double timeSec = 0.0;
+};
+
+InvariantResult computePInvariants(const Model& model, const InvariantOptions& opts = InvariantOptions());
+InvariantResult computeTInvariants(const Model& model, const InvariantOptions& opts = InvariantOptions());
+
+// Every place is in the support of some P-invariant (the net is conservative, hence bounded)
+bool coveredByInvariants(const vector<Invariant>& pInvariants, size_t numPlaces);
+
+// A place fixed by the others through the P-invariants:
+// div * M[place] + sum coef * B[pos] = value, pos indexing the basis marking B
+struct ImpliedPlace {
+    int place;
+    long long div;
+    long long value;
+    vector<pair<int, long long>> terms;  // (position in the basis marking, coef)
+};
+
+// Stores a marking as its basis places only; the places implied by the
+// P-invariants are rebuilt on demand. Exact for every reachable marking.
+class PlaceBasis {
+public:
+    PlaceBasis() = default;  // No invariants: every place is in the basis
+    PlaceBasis(size_t numPlaces, const vector<Invariant>& pInvariants);
+
+    size_t size() const { return basis.size(); }  // Places stored per marking
+    size_t implied() const { return rules.size(); }
+    Marking compress(Marking M) const;
+    Marking expand(const Marking& B) const;
+
+private:
+    size_t numPlaces = 0;
+    vector<int> basis;           // Original indices of the stored places
+    vector<ImpliedPlace> rules;  // One per independent P-invariant
+};
+
+// BDD variable order: places of one P-invariant next to each other, each
+// invariant after the one sharing the most places with those already placed;
+// places in no invariant come last
+vector<int> invariantPlaceOrder(const vector<Invariant>& pInvariants, size_t numPlaces);
+
+// "2*p0 + p1 = 3" (P, value shown) or "t0 + t1" (T)
+string toString(const Invariant& inv, const vector<string>& names, bool withValue);
+
+#endif
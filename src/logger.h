@@ -0,0 +1,106 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+/*
+ * logger.h - Leveled, buffered logging for the Petri Net Solver
+ * Disabled messages cost a single comparison; enabled ones are accumulated
+ * in a buffer and written to stdout in large chunks instead of per-line flushes.
+ */
+
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <chrono>
+
+enum class LogLevel {
+    WARN = 0,   // Warnings and errors only (default, quiet)
+    INFO = 1,   // Phase progress and timings (--verbose)
+    DEBUG = 2   // Per-element details (--log-level debug)
+};
+
+class Logger {
+public:
+    static Logger& get() {
+        static Logger instance;
+        return instance;
+    }
+
+    void setLevel(LogLevel lvl) { level_ = lvl; }
+    LogLevel level() const { return level_; }
+    bool enabled(LogLevel lvl) const { return lvl <= level_; }
+
+    void write(LogLevel lvl, const std::string& line) {
+        if (lvl == LogLevel::WARN) {
+            flush();  // keep ordering with buffered output
+            std::cerr << line << '\n';
+            return;
+        }
+        buf_ += line;
+        buf_ += '\n';
+        if (buf_.size() >= kFlushBytes) flush();
+    }
+
+    void flush() {
+        if (buf_.empty()) return;
+        std::cout.write(buf_.data(), (std::streamsize)buf_.size());
+        std::cout.flush();
+        buf_.clear();
+    }
+
+    ~Logger() { flush(); }
+
+private:
+    Logger() = default;
+    static constexpr size_t kFlushBytes = 64 * 1024;
+    LogLevel level_ = LogLevel::WARN;
+    std::string buf_;
+};
+
+// Parse "warn" / "info" / "debug"; returns false on unknown name
+inline bool parseLogLevel(const std::string& name, LogLevel& out) {
+    if (name == "warn")  { out = LogLevel::WARN;  return true; }
+    if (name == "info")  { out = LogLevel::INFO;  return true; }
+    if (name == "debug") { out = LogLevel::DEBUG; return true; }
+    return false;
+}
+
+// The message expression is only evaluated when the level is enabled
+#define LOG_AT(lvl, expr)                                   \
+    do {                                                    \
+        if (Logger::get().enabled(lvl)) {                   \
+            std::ostringstream log_oss_;                    \
+            log_oss_ << expr;                               \
+            Logger::get().write(lvl, log_oss_.str());       \
+        }                                                   \
+    } while (0)
+
+#define LOG_WARN(expr)  LOG_AT(LogLevel::WARN, expr)
+#define LOG_INFO(expr)  LOG_AT(LogLevel::INFO, expr)
+#define LOG_DEBUG(expr) LOG_AT(LogLevel::DEBUG, expr)
+
+// Measures one phase and logs "<tag> phase <name>: <ms> ms" at INFO when stopped
+class PhaseTimer {
+public:
+    PhaseTimer(const char* tag, const char* name)
+        : tag_(tag), name_(name), start_(std::chrono::steady_clock::now()) {}
+
+    double stop() {
+        if (stopped_) return ms_;
+        stopped_ = true;
+        ms_ = std::chrono::duration<double, std::milli>(
+                  std::chrono::steady_clock::now() - start_).count();
+        LOG_INFO(tag_ << " phase " << name_ << ": " << ms_ << " ms");
+        return ms_;
+    }
+
+    ~PhaseTimer() { stop(); }
+
+private:
+    const char* tag_;
+    const char* name_;
+    std::chrono::steady_clock::time_point start_;
+    bool stopped_ = false;
+    double ms_ = 0.0;
+};
+
+#endif // LOGGER_H
@@ -1,7 +1,8 @@
 /*
  * main.cpp - Petri Net Solver CLI
  * Integrates all modules: Parser, Explicit, BDD, ILP
- * Usage: ./petri_solver --input <file.pnml> --mode <all|explicit|bdd> [--optimize]
+ * Usage: ./petri_solver --input <file.pnml> --mode <all|explicit|bdd|cover> [--optimize]
+ *        ./petri_solver --batch <dir|listfile> [--jobs N] [options]
  */
 
 #include <iostream>
@@ -11,18 +12,28 @@
 #include <cstring>
 #include <iomanip>
 #include <cstdlib>
+#include <algorithm>
+#include <filesystem>
 
 #ifdef _WIN32
     #include <direct.h>
     #define MKDIR(dir) _mkdir(dir)
 #else
     #include <sys/stat.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
     #define MKDIR(dir) mkdir(dir, 0755)
 #endif
 
 #include "utils.h"
+#include "logger.h"
 #include "parser.h"
+#include "model_cache.h"
 #include "reachability.h"
+#include "coverability.h"
+#include "reduction.h"
+#include "invariants.h"
+#include "symmetry.h"
 #include "bdd.h"
 
 #ifdef HAS_GLPK
@@ -43,112 +54,330 @@ void createDirectory(const string& path) {
 
 void printUsage() {
     cout << "Usage: ./petri_solver --input <file.pnml> [options]\n";
+    cout << "       ./petri_solver --batch <dir|listfile> [options]\n";
     cout << "Options:\n";
-    cout << "  --input <file>     : Path to input PNML file (Required)\n";
-    cout << "  --mode <mode>      : 'explicit', 'bdd', or 'all' (Default: all)\n";
+    cout << "  --input <file>     : Path to input PNML file (Required unless --batch)\n";
+    cout << "  --batch <path>     : Analyse every *.pnml in a directory, or each path listed in a file\n";
+    cout << "  --jobs <N>         : Batch only: run models in N worker processes (Default: 1)\n";
+    cout << "  --mode <mode>      : 'explicit', 'bdd', 'all', or 'cover' (Default: all)\n";
+    cout << "                       'cover': coverability set / place bounds, also for unbounded nets\n";
     cout << "  --optimize         : Enable ILP Optimization (Task 5)\n";
     cout << "  --outdir <path>    : Directory to save results (Default: output/)\n";
+    cout << "  --no-cache         : Do not read/write the compiled model cache (<input>.pnmc)\n";
+    cout << "  --bdd-cache <dir>  : Persist the BDD reachable set in <dir>, reused for unchanged models\n";
+    cout << "  --bdd-workers <N>  : Experimental: split the BDD image over N forked processes (Default: 1, POSIX only)\n";
+    cout << "                       The parent still loads, ORs and diffs every slice alone, so no speedup is\n";
+    cout << "                       measured; the kernel itself stays single-threaded\n";
+    cout << "  --mem-limit <MB>   : Cap the BDD node table / explicit state store; partial result when full\n";
+    cout << "  --reduce           : Apply structural reductions before explicit/BDD/ILP (keeps deadlocks):\n";
+    cout << "                       dead/constant places, self-loops, places that exactly duplicate\n";
+    cout << "                       another's arcs, series fusion (other implicit places are kept)\n";
+    cout << "  --invariants       : Report P-/T-invariants (Farkas) and write invariants.txt\n";
+    cout << "  --no-invariant-order : BDD: keep place index order instead of grouping P-invariants\n";
+    cout << "  --no-compress      : Explicit: store every place instead of the places P-invariants leave free\n";
+    cout << "  --symmetry         : Explicit: detect net automorphisms, store one marking per orbit\n";
+    cout << "  --store <kind>     : Explicit visited store: 'exact', 'hashcompact' or 'bitstate' (Default: exact)\n";
+    cout << "                       the last two may miss markings; the omission probability is reported\n";
+    cout << "  --bits-per-state <b> : hashcompact: fingerprint bits (Default: 64); bitstate: filter bits (Default: 16)\n";
+    cout << "  --hash-functions <k> : bitstate: bits set per marking (Default: 3)\n";
+    cout << "  --disk-bfs <dir>   : Explicit: BFS with the visited set and layers as sorted files in <dir>\n";
+    cout << "                       (delayed duplicate detection; --mem-limit sizes the sort buffer)\n";
+    cout << "  --checkpoint <dir> : Save explicit BFS / BDD fixpoint progress in <dir> (kept if the run is partial)\n";
+    cout << "  --checkpoint-interval <s> : Seconds between checkpoints (Default: 300)\n";
+    cout << "  --resume           : Continue from a matching checkpoint in the --checkpoint dir\n";
+    cout << "  --sweep            : Explicit: sweep-line, forget markings the progress measure has passed\n";
+    cout << "  --progress <file>  : Sweep-line measure, lines '<place> <weight>' (Default: derived from the net)\n";
+    cout << "  --sweep-distinct   : Sweep-line: count markings revisited by later sweeps once\n";
+    cout << "                       (64-bit fingerprint per marking, like --store hashcompact)\n";
+    cout << "  --bound <k>        : BDD: fix the token bound per place (Default: from M0/weights, widened on overflow)\n";
+    cout << "  --verbose          : Log phase progress and timings (same as --log-level info)\n";
+    cout << "  --log-level <lvl>  : 'warn', 'info' or 'debug' (Default: warn)\n";
     cout << "  --help             : Show this help message\n";
     cout << "Example:\n";
     cout << "  ./petri_solver --input data/simple_test.pnml --mode bdd --optimize\n";
+    cout << "  ./petri_solver --batch data --jobs 4\n";
 }
 
-int main(int argc, char* argv[]) {
-    // Parse CLI arguments
-    string inputFile;
+struct CliOptions {
     string mode = "all";
     string outDir = "output/";
     bool doOptimize = false;
+    bool useCache = true;
+    string bddCacheDir;
+    int bddWorkers = 1;
+    double memLimitMB = 0;
+    int tokenBound = 0;
+    bool reduce = false;
+    bool invariants = false;
+    bool invariantOrder = true;
+    bool compress = true;
+    bool symmetry = false;
+    StateStore store = StateStore::EXACT;
+    int bitsPerState = 0;
+    int hashFunctions = 3;
+    string diskDir;
+    string checkpointDir;
+    double checkpointSec = 300;
+    bool resume = false;
+    bool sweep = false;
+    bool sweepDistinct = false;
+    string progressFile;
+};
 
-    if (argc < 2) {
-        printUsage();
-        return 1;
-    }
+static const char* CSV_HEADER = "Model,Method,States,TimeSec,MemMB,Deadlock,OptObj,OptMarking,"
+                                "GcCount,GcTimeSec,Resizes,PeakNodes,HitApply,HitIte,HitQuant,"
+                                "HitAppex,HitReplace,HitMisc,Complete\n";
+static const char* CSV_NO_TELEMETRY = ",N/A,N/A,N/A,N/A,N/A,N/A,N/A,N/A,N/A,N/A";
 
-    for (int i = 1; i < argc; ++i) {
-        if (strcmp(argv[i], "--input") == 0 && i + 1 < argc) {
-            inputFile = argv[++i];
-        } else if (strcmp(argv[i], "--mode") == 0 && i + 1 < argc) {
-            mode = argv[++i];
-        } else if (strcmp(argv[i], "--outdir") == 0 && i + 1 < argc) {
-            outDir = argv[++i];
-        } else if (strcmp(argv[i], "--optimize") == 0) {
-            doOptimize = true;
-        } else if (strcmp(argv[i], "--help") == 0) {
-            printUsage();
-            return 0;
-        }
+// Trailing columns of a BDD row: BuDDy telemetry (unused caches -> N/A), Complete
+static string bddTailColumns(const BddResult& r) {
+    const BddTelemetry& t = r.telemetry;
+    ostringstream out;
+    out << "," << t.gcCount << "," << t.gcTimeSec << "," << t.resizeCount << "," << t.peakLiveNodes;
+    for (double rate : t.cacheHitRate) {
+        if (rate < 0) out << ",N/A";
+        else out << "," << rate;
     }
+    out << "," << (r.complete ? "Yes" : "No");
+    return out.str();
+}
 
-    if (inputFile.empty()) {
-        cerr << "[ERROR] Missing input file! Use --input.\n";
-        return 1;
+// Bring an existing result.csv to CSV_HEADER before appending to it. Older
+// headers are prefixes of the current one (columns are only ever appended),
+// so their rows are padded with N/A; any other header is moved to .bak
+static void upgradeCsvFile(const string& path) {
+    ifstream in(path);
+    string first;
+    if (!in.good() || !getline(in, first)) return;
+    if (!first.empty() && first.back() == '\r') first.pop_back();
+    string header = CSV_HEADER;
+    header.pop_back();  // '\n'
+    if (first == header) return;
+
+    vector<string> rows;
+    for (string line; getline(in, line); ) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        rows.push_back(line);
     }
+    in.close();
 
-    createDirectory(outDir);
+    bool prefix = !first.empty() && header.compare(0, first.size() + 1, first + ",") == 0;
+    if (!prefix) {
+        string backup = path + ".bak";
+        error_code ec;
+        filesystem::rename(path, backup, ec);
+        cout << "[WARN] " << path << " has an unknown header, "
+             << (ec ? "overwriting it" : "moved to " + backup) << endl;
+        if (ec) ofstream(path, ios::trunc) << CSV_HEADER;
+        return;
+    }
 
-    // Prepare CSV output
-    string csvPath = outDir + "result.csv";
-    bool fileExists = false;
-    ifstream checkFile(csvPath);
-    if (checkFile.good()) fileExists = true;
-    checkFile.close();
+    string pad;
+    for (size_t i = first.size(); i < header.size(); ++i)
+        if (header[i] == ',') pad += ",N/A";
+    ofstream out(path, ios::trunc);
+    out << CSV_HEADER;
+    for (const string& row : rows) out << row << (row.empty() ? "" : pad) << "\n";
+    cout << "[INFO] Upgraded " << path << " to the current CSV columns" << endl;
+}
 
-    ofstream csvFile(csvPath, ios::app);
-    if (!csvFile.is_open()) {
-        cerr << "[ERROR] Cannot open " << csvPath << "\n";
-        return 1;
+// Sweep-line weights from "<place> <weight>" lines ('#' starts a comment); unlisted places weigh 0
+static vector<long long> readProgressMeasure(const string& path, const Model& model) {
+    ifstream in(path);
+    if (!in) throw runtime_error("Cannot open progress measure: " + path);
+    vector<long long> weights(model.places.size(), 0);
+    string line;
+    while (getline(in, line)) {
+        line = line.substr(0, line.find('#'));
+        istringstream fields(line);
+        string place;
+        long long weight;
+        if (!(fields >> place)) continue;
+        if (!(fields >> weight)) throw runtime_error("Bad progress measure line: " + line);
+        auto it = model.placeIndex.find(place);
+        if (it == model.placeIndex.end()) {
+            cout << "[WARN] Progress measure: unknown place " << place << ", ignored" << endl;
+            continue;
+        }
+        weights[it->second] = weight;
     }
+    return weights;
+}
 
-    if (!fileExists)
-        csvFile << "Model,Method,States,TimeSec,MemMB,Deadlock,OptObj,OptMarking\n";
-
+// Run all requested tasks on one model, appending its rows to csvFile.
+// Side files (DOT, bounds.txt, deadlock.txt, optimum.txt) go to artifactDir.
+static bool runModel(const string& inputFile, const CliOptions& cli,
+                     const string& artifactDir, ostream& csvFile) {
+    const string& mode = cli.mode;
     string modelName = inputFile.substr(inputFile.find_last_of("/\\") + 1);
 
     try {
         // Task 1: Parse PNML
         cout << "[INFO] Parsing PNML: " << inputFile << "..." << endl;
-        Model model = parsePNML(inputFile, true, outDir + "petri_net.dot");
-        cout << "[INFO] Parsed successfully. Places: " << model.places.size() 
-             << ", Transitions: " << model.transitions.size() << endl;
+        Model parsed = loadModel(inputFile, cli.useCache, true, artifactDir + "petri_net.dot");
+        cout << "[INFO] Parsed successfully. Places: " << parsed.places.size() 
+             << ", Transitions: " << parsed.transitions.size() << endl;
+
+        // Rút gọn cấu trúc: giữ deadlock; Task 5 và coverability cần mọi place nên giữ lại hết
+        Reduction red;
+        bool reduced = cli.reduce && mode != "cover";
+        if (reduced) {
+            ReduceOptions reduceOpts;
+            if (cli.doOptimize)
+                for (size_t p = 0; p < parsed.places.size(); ++p) reduceOpts.keepPlaces.push_back((int)p);
+            red = reduceModel(parsed, reduceOpts);
+            reduced = !red.reduced.places.empty();
+            cout << "[INFO] Reduced net. Places: " << red.reduced.places.size()
+                 << ", Transitions: " << red.reduced.transitions.size()
+                 << (reduced ? "" : " (empty, using the original net)") << endl;
+        }
+        const Model& model = reduced ? red.reduced : parsed;
+        // States của net đã rút gọn khác net gốc: dòng CSV mang hậu tố riêng
+        string reducedTag = reduced ? "Reduced" : "";
+
+        // P-invariants của net đang phân tích (sau rút gọn nếu có): nén marking của explicit,
+        // sắp thứ tự biến BDD và thêm ràng buộc y·M = y·M0 cho ILP; --invariants in thêm T-invariants
+        bool explicitMode = mode == "explicit" || mode == "all";
+        bool bddMode = mode == "bdd" || mode == "all";
+        InvariantResult pInv;
+        if (cli.invariants || (bddMode && cli.invariantOrder) || (explicitMode && cli.compress))
+            pInv = computePInvariants(model);
+        if (cli.invariants) {
+            cout << "[INFO] Computing P-/T-invariants (Farkas)..." << endl;
+            InvariantResult tInv = computeTInvariants(model);
+            cout << "       -> P-invariants: " << pInv.invariants.size()
+                 << (pInv.complete ? "" : " (gave up)") << ", T-invariants: " << tInv.invariants.size()
+                 << (tInv.complete ? "" : " (gave up)") << ", Conservative: "
+                 << (pInv.complete && coveredByInvariants(pInv.invariants, model.places.size()) ? "Yes" : "No")
+                 << endl;
+
+            ofstream invFile(artifactDir + "invariants.txt");
+            invFile << "P-invariants:" << (pInv.complete ? "" : " (incomplete)") << "\n";
+            for (const auto& inv : pInv.invariants) invFile << "  " << toString(inv, model.places, true) << "\n";
+            invFile << "T-invariants:" << (tInv.complete ? "" : " (incomplete)") << "\n";
+            for (const auto& inv : tInv.invariants) invFile << "  " << toString(inv, model.transitions, false) << "\n";
+        }
 
         // Task 2: Explicit Reachability
-        if (mode == "explicit" || mode == "all") {
+        if (explicitMode) {
             cout << "[INFO] Task 2: Running Explicit Reachability (BFS/DFS)..." << endl;
             ReachOptions reachOpts;
+            if (cli.compress) reachOpts.invariants = pInv.invariants;
+            PlaceBasis stored(model.places.size(), reachOpts.invariants);
+            reachOpts.store = cli.store;
+            reachOpts.bitsPerState = cli.bitsPerState;
+            reachOpts.hashFunctions = cli.hashFunctions;
+            reachOpts.diskDir = cli.diskDir;
+            reachOpts.checkpointDir = cli.checkpointDir;
+            reachOpts.checkpointSec = cli.checkpointSec;
+            reachOpts.resume = cli.resume;
+            reachOpts.sweep = cli.sweep;
+            reachOpts.sweepDistinct = cli.sweepDistinct;
+            if (!cli.progressFile.empty()) reachOpts.progress = readProgressMeasure(cli.progressFile, model);
+            // Disk BFS: --mem-limit chỉ giới hạn bộ đệm sắp xếp, số marking không bị chặn
+            if (!cli.diskDir.empty() && cli.memLimitMB > 0) reachOpts.diskBufferMB = cli.memLimitMB / 2;
+            else if (cli.diskDir.empty())
+                reachOpts.maxStates = explicitStateCap(model, cli.memLimitMB, stored.size(), cli.store, cli.bitsPerState);
+            if (cli.symmetry) reachOpts.symmetry = findSymmetries(model);
             ReachResult res = explicitReach(model, reachOpts);
-            cout << "       -> States: " << res.states << ", Time: " << res.timeSec << "s" << endl;
-            csvFile << modelName << ",Explicit," << res.states << "," 
-                    << res.timeSec << "," << res.memMB << ",N/A,N/A,N/A\n";
+            cout << "       -> States: " << res.states << ", Time: " << res.timeSec << "s"
+                 << (res.complete ? "" : " (partial)") << endl;
+            // Kiểu lưu xấp xỉ: States là cận dưới, kèm xác suất đã bỏ sót marking
+            // Nhiều lượt quét: States đếm mỗi lượt một lần (cận trên), hoặc qua fingerprint
+            // 64 bit với --sweep-distinct, kèm xác suất đếm thiếu
+            if (cli.sweep) {
+                cout << "       -> Sweep-line, peak stored markings: " << res.peakStored;
+                if (res.sweeps > 1 && !cli.sweepDistinct)
+                    cout << ", " << res.sweeps << " sweeps (States is an upper bound)";
+                if (cli.sweepDistinct) cout << ", P(count low) ~ " << res.omissionProb;
+                cout << endl;
+            }
+            if (cli.store != StateStore::EXACT && cli.diskDir.empty() && !cli.sweep)
+                cout << "       -> Approximate store, P(markings missed) ~ " << res.omissionProb << endl;
+            // Với đối xứng, States là số marking đại diện (mỗi quỹ đạo một marking)
+            if (!reachOpts.symmetry.trivial())
+                cout << "       -> Symmetry |G| = " << reachOpts.symmetry.order() << ", markings represented: "
+                     << (res.orbitStates ? to_string(res.orbitStates) : "unknown (canonical form by descent)") << endl;
+            string method = reachOpts.symmetry.trivial() ? "Explicit" : "ExplicitSymmetry";
+            if (cli.sweep) method += "Sweep";
+            else if (!cli.diskDir.empty()) method += "Disk";
+            else if (cli.store == StateStore::HASH_COMPACT) method += "HashCompact";
+            else if (cli.store == StateStore::BITSTATE) method += "Bitstate";
+            method += reducedTag;
+            csvFile << modelName << "," << method << "," << res.states << "," 
+                    << res.timeSec << "," << res.memMB << ",N/A,N/A,N/A" << CSV_NO_TELEMETRY
+                    << "," << (res.complete ? "Yes" : "No") << "\n";
+        }
+
+        // Coverability (Karp–Miller): kết thúc cả với mạng không bị chặn
+        if (mode == "cover") {
+            cout << "[INFO] Computing Coverability Set (Karp-Miller)..." << endl;
+            CoverOptions coverOpts;
+            coverOpts.maxNodes = explicitStateCap(model, cli.memLimitMB);
+            CoverResult cov = coverability(model, coverOpts);
+            cout << "       -> Omega-markings: " << cov.mcs.size() << ", Bounded: "
+                 << (cov.bounded ? "Yes" : "No") << ", Time: " << cov.timeSec << "s"
+                 << (cov.complete ? "" : " (partial)") << endl;
+            csvFile << modelName << ",Coverability," << cov.mcs.size() << ","
+                    << cov.timeSec << "," << cov.memMB << ",N/A,N/A,N/A" << CSV_NO_TELEMETRY
+                    << "," << (cov.complete ? "Yes" : "No") << "\n";
+
+            ofstream boundFile(artifactDir + "bounds.txt");
+            boundFile << "Bounded: " << (cov.bounded ? "Yes" : "No") << "\n";
+            for (size_t p = 0; p < model.places.size(); ++p) {
+                boundFile << model.places[p] << ": ";
+                if (cov.placeBound[p] == OMEGA) boundFile << "unbounded\n";
+                else boundFile << cov.placeBound[p] << "\n";
+            }
+            for (const auto& M : cov.mcs) boundFile << toString(M) << "\n";
         }
 
         // Task 3: Symbolic Reachability (BDD)
         BddResult bddRes;
-        if (mode == "bdd" || mode == "all") {
+        if (bddMode) {
             cout << "[INFO] Task 3: Running Symbolic Reachability (BDD)..." << endl;
             BddOptions bddOpts;
+            bddOpts.cacheDir = cli.bddCacheDir;
+            bddOpts.workers = cli.bddWorkers;
+            bddOpts.memLimitMB = cli.memLimitMB;
+            bddOpts.tokenBound = cli.tokenBound;
+            bddOpts.checkpointDir = cli.checkpointDir;
+            bddOpts.checkpointSec = cli.checkpointSec;
+            bddOpts.resume = cli.resume;
+            if (cli.invariantOrder && !pInv.invariants.empty())
+                bddOpts.placeOrder = invariantPlaceOrder(pInv.invariants, model.places.size());
             bddRes = bddReach(model, bddOpts);
             cout << "       -> States: " << bddRes.states << ", Nodes: " << bddRes.nodeCount 
-                 << ", Time: " << bddRes.timeSec << "s" << endl;
-            csvFile << modelName << ",BDD," << bddRes.states << "," 
+                 << ", Time: " << bddRes.timeSec << "s"
+                 << (bddRes.fromCache ? " (cached)" : "")
+                 << (bddRes.complete ? "" : " (partial)") << endl;
+            csvFile << modelName << ",BDD" << reducedTag << "," << bddRes.states << "," 
                     << bddRes.timeSec << "," << bddRes.memMB << ",";
         }
 
 
         // Task 4 & 5: ILP-based analysis (requires GLPK)
 #ifdef HAS_GLPK
-        if (mode == "bdd" || mode == "all") {
+        // Marking của net gốc cho một marking của net đang phân tích
+        auto original = [&](const Marking& M) { return reduced ? red.expand(M) : M; };
+        // The ILP would treat reachable markings missing from a partial Reached as unreachable
+        if ((mode == "bdd" || mode == "all") && !bddRes.complete) {
+            cout << "[WARN] Reachable set is partial - Task 4 & 5 skipped" << endl;
+            csvFile << "N/A,N/A,N/A" << bddTailColumns(bddRes) << "\n";
+        } else if (mode == "bdd" || mode == "all") {
             // Task 4: Deadlock Detection
             cout << "[INFO] Task 4: Detecting Deadlock (ILP + BDD)..." << endl;
             IlpOptions ilpOpts;
             ilpOpts.mode = IlpMode::DEADLOCK;
+            ilpOpts.invariants = pInv.invariants;
             IlpResult deadlockRes = solveILP(model, bddRes, ilpOpts);
             
-            ofstream dlFile(outDir + "deadlock.txt");
+            ofstream dlFile(artifactDir + "deadlock.txt");
             if (deadlockRes.hasDeadlock && deadlockRes.isReachable) {
-                cout << "       [FOUND] Deadlock at: " << toString(deadlockRes.deadlockMarking) << endl;
+                Marking dead = original(deadlockRes.deadlockMarking);
+                cout << "       [FOUND] Deadlock at: " << toString(dead) << endl;
                 csvFile << "Yes,";
-                dlFile << "Deadlock: " << toString(deadlockRes.deadlockMarking) << endl;
+                dlFile << "Deadlock: " << toString(dead) << endl;
             } else {
                 cout << "       [NONE] No reachable deadlock found." << endl;
                 csvFile << "No,";
@@ -157,31 +386,34 @@ int main(int argc, char* argv[]) {
             dlFile.close();
 
             // Task 5: Optimization
-            if (doOptimize) {
+            if (cli.doOptimize) {
                 cout << "[INFO] Task 5: Optimizing Objective (Maximize c^T M)..." << endl;
                 IlpOptions optOpts;
                 optOpts.mode = IlpMode::OPTIMIZATION;
                 optOpts.weights.assign(model.places.size(), 1);
+                optOpts.invariants = pInv.invariants;
                 IlpResult optRes = solveILP(model, bddRes, optOpts);
                 
-                ofstream optFile(outDir + "optimum.txt");
+                ofstream optFile(artifactDir + "optimum.txt");
                 if (optRes.isReachable) {
                     cout << "       -> Max Value: " << optRes.optObj << endl;
-                    csvFile << optRes.optObj << ",\"" << toString(optRes.optMarking) << "\"\n";
-                    optFile << "Max: " << optRes.optObj << ", Marking: " << toString(optRes.optMarking) << "\n";
+                    Marking best = original(optRes.optMarking);
+                    csvFile << optRes.optObj << ",\"" << toString(best) << "\""
+                            << bddTailColumns(bddRes) << "\n";
+                    optFile << "Max: " << optRes.optObj << ", Marking: " << toString(best) << "\n";
                 } else {
-                    csvFile << "N/A,N/A\n";
+                    csvFile << "N/A,N/A" << bddTailColumns(bddRes) << "\n";
                     optFile << "None\n";
                 }
                 optFile.close();
             } else {
-                csvFile << "N/A,N/A\n";
+                csvFile << "N/A,N/A" << bddTailColumns(bddRes) << "\n";
             }
         }
 #else
         if (mode == "bdd" || mode == "all") {
             cout << "[WARN] GLPK not available - Task 4 & 5 skipped" << endl;
-            csvFile << "N/A,N/A,N/A\n";
+            csvFile << "N/A,N/A,N/A" << bddTailColumns(bddRes) << "\n";
         }
 #endif
 
@@ -189,12 +421,288 @@ int main(int argc, char* argv[]) {
 
     } catch (const exception& e) {
         cerr << "\n[FATAL ERROR] Exception occurred: " << e.what() << endl;
+        return false;
+    }
+    return true;
+}
+
+// ======== BATCH MODE ========
+
+// Inputs of a batch: sorted *.pnml of a directory, or non-empty,
+// non-'#' lines of a list file
+static vector<string> collectBatchInputs(const string& path) {
+    namespace fs = std::filesystem;
+    vector<string> inputs;
+    error_code ec;
+
+    if (fs::is_directory(path, ec)) {
+        for (const auto& entry : fs::directory_iterator(path, ec)) {
+            if (entry.is_regular_file(ec) && entry.path().extension() == ".pnml")
+                inputs.push_back(entry.path().string());
+        }
+        sort(inputs.begin(), inputs.end());
+        return inputs;
+    }
+
+    ifstream list(path);
+    if (!list) throw runtime_error("Cannot open batch list: " + path);
+    string line;
+    while (getline(list, line)) {
+        line.erase(0, line.find_first_not_of(" \t\r"));
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (!line.empty() && line[0] != '#') inputs.push_back(line);
+    }
+    return inputs;
+}
+
+// Per-model side files live in <outDir>/<model stem>/ so they do not collide
+static string batchArtifactDir(const CliOptions& cli, const string& inputFile) {
+    string name = inputFile.substr(inputFile.find_last_of("/\\") + 1);
+    string stem = name.substr(0, name.find_last_of('.'));
+    string dir = cli.outDir + stem + "/";
+    createDirectory(dir);
+    return dir;
+}
+
+// Sequential batch: one process, BuDDy stays initialised across models
+static int runBatchSequential(const vector<string>& inputs, const CliOptions& cli, ostream& csv) {
+    int failures = 0;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        cout << "[BATCH] (" << i + 1 << "/" << inputs.size() << ") " << inputs[i] << endl;
+        if (!runModel(inputs[i], cli, batchArtifactDir(cli, inputs[i]), csv)) ++failures;
+        csv.flush();
+    }
+    return failures;
+}
+
+#ifndef _WIN32
+// Parallel batch: model i goes to worker i % jobs; each model's rows land in a
+// part file that the parent concatenates in input order.
+static int runBatchParallel(const vector<string>& inputs, const CliOptions& cli,
+                            int jobs, ostream& csv) {
+    auto partPath = [&](size_t i) { return cli.outDir + ".batch-" + to_string(i) + ".csv"; };
+
+    // A child inherits unflushed buffers and would write them out a second time
+    Logger::get().flush();
+    cout.flush();
+    cerr.flush();
+    csv.flush();
+
+    vector<pid_t> workers;
+    for (int w = 0; w < jobs; ++w) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            cerr << "[BATCH] fork failed, running remaining models in-process" << endl;
+            break;
+        }
+        if (pid == 0) {
+            int failures = 0;
+            for (size_t i = w; i < inputs.size(); i += jobs) {
+                ofstream part(partPath(i));
+                if (!runModel(inputs[i], cli, batchArtifactDir(cli, inputs[i]), part)) ++failures;
+            }
+            Logger::get().flush();
+            cout.flush();
+            _exit(failures > 0 ? 1 : 0);
+        }
+        workers.push_back(pid);
+    }
+
+    int failures = 0;
+    for (pid_t pid : workers) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) ++failures;
+    }
+
+    // Slices whose worker could not be started are run here
+    for (int w = (int)workers.size(); w < jobs; ++w) {
+        for (size_t i = w; i < inputs.size(); i += jobs) {
+            ofstream part(partPath(i));
+            if (!runModel(inputs[i], cli, batchArtifactDir(cli, inputs[i]), part)) ++failures;
+        }
+    }
+
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        ifstream part(partPath(i));
+        if (part) csv << part.rdbuf();
+        part.close();
+        remove(partPath(i).c_str());
+    }
+    return failures;
+}
+#endif
+
+static int runBatch(const string& batchPath, const CliOptions& cli, int jobs) {
+    vector<string> inputs;
+    try {
+        inputs = collectBatchInputs(batchPath);
+    } catch (const exception& e) {
+        cerr << "[ERROR] " << e.what() << endl;
+        return 1;
+    }
+    if (inputs.empty()) {
+        cerr << "[ERROR] No PNML inputs found in " << batchPath << endl;
+        return 1;
+    }
+
+    // A batch always produces a fresh, consolidated result.csv
+    string csvPath = cli.outDir + "result.csv";
+    ofstream csvFile(csvPath, ios::trunc);
+    if (!csvFile.is_open()) {
+        cerr << "[ERROR] Cannot open " << csvPath << "\n";
+        return 1;
+    }
+    csvFile << CSV_HEADER;
+
+    jobs = max(1, min(jobs, (int)inputs.size()));
+    cout << "[BATCH] " << inputs.size() << " models, " << jobs << " worker(s)" << endl;
+
+    int failures;
+#ifndef _WIN32
+    if (jobs > 1)
+        failures = runBatchParallel(inputs, cli, jobs, csvFile);
+    else
+#endif
+        failures = runBatchSequential(inputs, cli, csvFile);
+
+    csvFile.close();
+    cout << "[BATCH] Done: " << inputs.size() - failures << "/" << inputs.size()
+         << " models succeeded. Results saved to '" << csvPath << "'." << endl;
+    return failures > 0 ? 1 : 0;
+}
+
+int main(int argc, char* argv[]) {
+    // Parse CLI arguments
+    string inputFile;
+    string batchPath;
+    int jobs = 1;
+    CliOptions cli;
+
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--input") == 0 && i + 1 < argc) {
+            inputFile = argv[++i];
+        } else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batchPath = argv[++i];
+        } else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            jobs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--mode") == 0 && i + 1 < argc) {
+            cli.mode = argv[++i];
+        } else if (strcmp(argv[i], "--outdir") == 0 && i + 1 < argc) {
+            cli.outDir = argv[++i];
+        } else if (strcmp(argv[i], "--optimize") == 0) {
+            cli.doOptimize = true;
+        } else if (strcmp(argv[i], "--bdd-cache") == 0 && i + 1 < argc) {
+            cli.bddCacheDir = argv[++i];
+        } else if (strcmp(argv[i], "--bdd-workers") == 0 && i + 1 < argc) {
+            cli.bddWorkers = max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--mem-limit") == 0 && i + 1 < argc) {
+            cli.memLimitMB = max(0.0, atof(argv[++i]));
+        } else if (strcmp(argv[i], "--reduce") == 0) {
+            cli.reduce = true;
+        } else if (strcmp(argv[i], "--invariants") == 0) {
+            cli.invariants = true;
+        } else if (strcmp(argv[i], "--no-invariant-order") == 0) {
+            cli.invariantOrder = false;
+        } else if (strcmp(argv[i], "--no-compress") == 0) {
+            cli.compress = false;
+        } else if (strcmp(argv[i], "--symmetry") == 0) {
+            cli.symmetry = true;
+        } else if (strcmp(argv[i], "--store") == 0 && i + 1 < argc) {
+            string kind = argv[++i];
+            if (kind == "exact") cli.store = StateStore::EXACT;
+            else if (kind == "hashcompact") cli.store = StateStore::HASH_COMPACT;
+            else if (kind == "bitstate") cli.store = StateStore::BITSTATE;
+            else {
+                cerr << "[ERROR] Unknown state store: " << kind << "\n";
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--bits-per-state") == 0 && i + 1 < argc) {
+            cli.bitsPerState = max(0, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--hash-functions") == 0 && i + 1 < argc) {
+            cli.hashFunctions = max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--disk-bfs") == 0 && i + 1 < argc) {
+            cli.diskDir = argv[++i];
+        } else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) {
+            cli.checkpointDir = argv[++i];
+        } else if (strcmp(argv[i], "--checkpoint-interval") == 0 && i + 1 < argc) {
+            cli.checkpointSec = max(0.0, atof(argv[++i]));
+        } else if (strcmp(argv[i], "--resume") == 0) {
+            cli.resume = true;
+        } else if (strcmp(argv[i], "--sweep") == 0) {
+            cli.sweep = true;
+        } else if (strcmp(argv[i], "--sweep-distinct") == 0) {
+            cli.sweepDistinct = true;
+            cli.sweep = true;
+        } else if (strcmp(argv[i], "--progress") == 0 && i + 1 < argc) {
+            cli.progressFile = argv[++i];
+            cli.sweep = true;
+        } else if (strcmp(argv[i], "--bound") == 0 && i + 1 < argc) {
+            cli.tokenBound = min(MAX_TOKENS, max(0, atoi(argv[++i])));
+        } else if (strcmp(argv[i], "--no-cache") == 0) {
+            cli.useCache = false;
+        } else if (strcmp(argv[i], "--verbose") == 0) {
+            Logger::get().setLevel(LogLevel::INFO);
+        } else if (strcmp(argv[i], "--log-level") == 0 && i + 1 < argc) {
+            LogLevel lvl;
+            if (!parseLogLevel(argv[++i], lvl)) {
+                cerr << "[ERROR] Unknown log level: " << argv[i] << "\n";
+                return 1;
+            }
+            Logger::get().setLevel(lvl);
+        } else if (strcmp(argv[i], "--help") == 0) {
+            printUsage();
+            return 0;
+        }
+    }
+
+    if (inputFile.empty() && batchPath.empty()) {
+        cerr << "[ERROR] Missing input file! Use --input or --batch.\n";
+        return 1;
+    }
+
+    if (!cli.outDir.empty() && cli.outDir.back() != '/' && cli.outDir.back() != '\\')
+        cli.outDir += '/';
+    createDirectory(cli.outDir);
+    if (!cli.bddCacheDir.empty()) createDirectory(cli.bddCacheDir);
+    if (!cli.diskDir.empty()) createDirectory(cli.diskDir);
+    if (!cli.checkpointDir.empty()) createDirectory(cli.checkpointDir);
+    if (cli.resume && cli.checkpointDir.empty()) {
+        cerr << "[ERROR] --resume needs --checkpoint <dir>\n";
+        return 1;
+    }
+
+    if (!batchPath.empty()) return runBatch(batchPath, cli, jobs);
+
+    // Prepare CSV output
+    string csvPath = cli.outDir + "result.csv";
+    upgradeCsvFile(csvPath);
+    bool fileExists = false;
+    ifstream checkFile(csvPath);
+    if (checkFile.good()) fileExists = true;
+    checkFile.close();
+
+    ofstream csvFile(csvPath, ios::app);
+    if (!csvFile.is_open()) {
+        cerr << "[ERROR] Cannot open " << csvPath << "\n";
+        return 1;
+    }
+
+    if (!fileExists)
+        csvFile << CSV_HEADER;
+
+    if (!runModel(inputFile, cli, cli.outDir, csvFile)) {
         csvFile.close();
         return 1;
     }
 
-    cout << "[INFO] All tasks completed. Results saved to '" << outDir << "'." << endl;
+    cout << "[INFO] All tasks completed. Results saved to '" << cli.outDir << "'." << endl;
     csvFile.close();
     
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,324 @@
+/*
+ * model_cache.cpp - Binary compiled-model cache (.pnmc)
+ * Writer builds the image in memory and renames it into place; reader maps
+ * the file and validates header, size and source checksum before use.
+ */
+
+#include "model_cache.h"
+#include "parser.h"
+#include "logger.h"
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <cstddef>
+
+#ifdef _WIN32
+    #include <vector>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+using namespace std;
+
+// ======== MAPPED FILE ========
+
+MappedFile::~MappedFile() { close(); }
+
+bool MappedFile::open(const string& path) {
+    close();
+#ifdef _WIN32
+    ifstream in(path, ios::binary | ios::ate);
+    if (!in) return false;
+    size_ = (size_t)in.tellg();
+    uint8_t* buf = new uint8_t[size_ ? size_ : 1];
+    in.seekg(0);
+    if (!in.read(reinterpret_cast<char*>(buf), (streamsize)size_)) {
+        delete[] buf;
+        size_ = 0;
+        return false;
+    }
+    data_ = buf;
+    return true;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+    data_ = static_cast<const uint8_t*>(p);
+    size_ = (size_t)st.st_size;
+    mapped_ = true;
+    return true;
+#endif
+}
+
+void MappedFile::close() {
+    if (!data_) return;
+#ifdef _WIN32
+    delete[] data_;
+#else
+    if (mapped_) munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    mapped_ = false;
+}
+
+// ======== HELPERS ========
+
+static size_t align8(size_t n) { return (n + 7) & ~size_t(7); }
+
+uint64_t fileChecksum(const string& path) {
+    MappedFile f;
+    if (!f.open(path)) return 0;
+    return fnv1a(f.data(), f.size());
+}
+
+string modelCachePath(const string& pnmlPath) {
+    return pnmlPath + ".pnmc";
+}
+
+// Appends raw arrays to the image, padding every section to 8 bytes
+class ImageWriter {
+public:
+    template <typename T>
+    void put(const T* data, size_t count) {
+        size_t bytes = sizeof(T) * count;
+        size_t at = buf_.size();
+        buf_.resize(align8(at + bytes), 0);
+        if (bytes) memcpy(buf_.data() + at, data, bytes);
+    }
+    vector<uint8_t>& bytes() { return buf_; }
+private:
+    vector<uint8_t> buf_;
+};
+
+// Builds CSR (rows = transitions) from a dense place x transition matrix
+static void denseToCsr(const vector<vector<int>>& M, size_t P, size_t T,
+                       vector<uint32_t>& rowPtr, vector<uint32_t>& idx, vector<int32_t>& w) {
+    rowPtr.assign(T + 1, 0);
+    for (size_t t = 0; t < T; ++t) {
+        for (size_t p = 0; p < P; ++p) {
+            if (M[p][t] != 0) {
+                idx.push_back((uint32_t)p);
+                w.push_back(M[p][t]);
+            }
+        }
+        rowPtr[t + 1] = (uint32_t)idx.size();
+    }
+}
+
+// ======== WRITER ========
+
+bool saveModelCache(const Model& model, uint64_t sourceChecksum, const string& cachePath) {
+    const size_t P = model.places.size();
+    const size_t T = model.transitions.size();
+
+    vector<uint32_t> strOffsets;
+    strOffsets.reserve(P + T + 1);
+    string strData;
+    strOffsets.push_back(0);
+    for (const auto& s : model.places)      { strData += s; strOffsets.push_back((uint32_t)strData.size()); }
+    for (const auto& s : model.transitions) { strData += s; strOffsets.push_back((uint32_t)strData.size()); }
+
+    vector<uint32_t> preRowPtr, preIdx, postRowPtr, postIdx;
+    vector<int32_t> preW, postW;
+    denseToCsr(model.Pre, P, T, preRowPtr, preIdx, preW);
+    denseToCsr(model.Post, P, T, postRowPtr, postIdx, postW);
+
+    CacheHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, MODEL_CACHE_MAGIC, 4);
+    h.version = MODEL_CACHE_VERSION;
+    h.sourceChecksum = sourceChecksum;
+    h.arcCount = model.arcCount;
+    h.numPlaces = (uint32_t)P;
+    h.numTransitions = (uint32_t)T;
+    h.preNnz = (uint32_t)preIdx.size();
+    h.postNnz = (uint32_t)postIdx.size();
+    h.strBytes = (uint32_t)strData.size();
+
+    vector<uint64_t> m0Bits((P + 63) / 64, 0);
+    for (size_t p = 0; p < P; ++p) {
+        if (model.M0[p] > 0) m0Bits[p / 64] |= 1ULL << (p % 64);
+        if (model.M0[p] > 1) h.flags |= CACHE_FLAG_M0_WIDE;
+    }
+
+    ImageWriter w;
+    w.put(&h, 1);
+    w.put(strOffsets.data(), strOffsets.size());
+    w.put(strData.data(), strData.size());
+    w.put(preRowPtr.data(), preRowPtr.size());
+    w.put(preIdx.data(), preIdx.size());
+    w.put(preW.data(), preW.size());
+    w.put(postRowPtr.data(), postRowPtr.size());
+    w.put(postIdx.data(), postIdx.size());
+    w.put(postW.data(), postW.size());
+    w.put(m0Bits.data(), m0Bits.size());
+    if (h.flags & CACHE_FLAG_M0_WIDE) w.put(model.M0.data(), P);
+
+    vector<uint8_t>& image = w.bytes();
+    uint64_t fileSize = image.size();
+    memcpy(image.data() + offsetof(CacheHeader, fileSize), &fileSize, sizeof(fileSize));
+
+    // Write to a temp file and rename so readers never see a partial cache
+    string tmpPath = cachePath + ".tmp";
+    {
+        ofstream out(tmpPath, ios::binary | ios::trunc);
+        if (!out) return false;
+        out.write(reinterpret_cast<const char*>(image.data()), (streamsize)image.size());
+        if (!out) {
+            out.close();
+            remove(tmpPath.c_str());
+            return false;
+        }
+    }
+    remove(cachePath.c_str());  // rename() does not overwrite on Windows
+    if (rename(tmpPath.c_str(), cachePath.c_str()) != 0) {
+        remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+// ======== READER ========
+
+bool CompiledModel::open(const string& path, uint64_t expectedChecksum) {
+    header_ = nullptr;
+    if (!file_.open(path)) return false;
+    if (file_.size() < sizeof(CacheHeader)) return false;
+
+    const CacheHeader* h = reinterpret_cast<const CacheHeader*>(file_.data());
+    if (memcmp(h->magic, MODEL_CACHE_MAGIC, 4) != 0) return false;
+    if (h->version != MODEL_CACHE_VERSION) return false;
+    if (h->fileSize != file_.size()) return false;
+    if (h->sourceChecksum != expectedChecksum) return false;
+
+    const size_t P = h->numPlaces, T = h->numTransitions;
+    size_t off = align8(sizeof(CacheHeader));
+    auto take = [&](size_t bytes) {
+        const uint8_t* p = file_.data() + off;
+        off = align8(off + bytes);
+        return p;
+    };
+
+    // Compute the expected size first so no pointer ever leaves the mapping
+    size_t need = off;
+    need = align8(need + sizeof(uint32_t) * (P + T + 1));
+    need = align8(need + h->strBytes);
+    need = align8(need + sizeof(uint32_t) * (T + 1));
+    need = align8(need + sizeof(uint32_t) * h->preNnz);
+    need = align8(need + sizeof(int32_t) * h->preNnz);
+    need = align8(need + sizeof(uint32_t) * (T + 1));
+    need = align8(need + sizeof(uint32_t) * h->postNnz);
+    need = align8(need + sizeof(int32_t) * h->postNnz);
+    need = align8(need + sizeof(uint64_t) * ((P + 63) / 64));
+    if (h->flags & CACHE_FLAG_M0_WIDE) need = align8(need + P);
+    if (need != file_.size()) return false;
+
+    strOffsets_ = reinterpret_cast<const uint32_t*>(take(sizeof(uint32_t) * (P + T + 1)));
+    strData_    = reinterpret_cast<const char*>(take(h->strBytes));
+    preRowPtr   = reinterpret_cast<const uint32_t*>(take(sizeof(uint32_t) * (T + 1)));
+    preIdx      = reinterpret_cast<const uint32_t*>(take(sizeof(uint32_t) * h->preNnz));
+    preW        = reinterpret_cast<const int32_t*>(take(sizeof(int32_t) * h->preNnz));
+    postRowPtr  = reinterpret_cast<const uint32_t*>(take(sizeof(uint32_t) * (T + 1)));
+    postIdx     = reinterpret_cast<const uint32_t*>(take(sizeof(uint32_t) * h->postNnz));
+    postW       = reinterpret_cast<const int32_t*>(take(sizeof(int32_t) * h->postNnz));
+    m0Bits_     = reinterpret_cast<const uint64_t*>(take(sizeof(uint64_t) * ((P + 63) / 64)));
+    m0Tokens_   = (h->flags & CACHE_FLAG_M0_WIDE) ? take(P) : nullptr;
+
+    // Offsets must start at 0, never decrease and end at the section size:
+    // name() and toModel() index strData/idx/w with them unchecked
+    auto monotonic = [](const uint32_t* v, size_t n, uint32_t last) {
+        if (v[0] != 0 || v[n - 1] != last) return false;
+        for (size_t i = 1; i < n; ++i) if (v[i] < v[i - 1]) return false;
+        return true;
+    };
+    if (!monotonic(strOffsets_, P + T + 1, h->strBytes)) return false;
+    if (!monotonic(preRowPtr, T + 1, h->preNnz) || !monotonic(postRowPtr, T + 1, h->postNnz)) return false;
+    for (uint32_t i = 0; i < h->preNnz; ++i)  if (preIdx[i] >= P) return false;
+    for (uint32_t i = 0; i < h->postNnz; ++i) if (postIdx[i] >= P) return false;
+
+    header_ = h;
+    return true;
+}
+
+Token CompiledModel::initialTokens(uint32_t p) const {
+    if (m0Tokens_) return m0Tokens_[p];
+    return (Token)((m0Bits_[p / 64] >> (p % 64)) & 1);
+}
+
+Model CompiledModel::toModel() const {
+    Model model;
+    const size_t P = numPlaces(), T = numTransitions();
+
+    model.places.reserve(P);
+    model.transitions.reserve(T);
+    model.placeIndex.reserve(P);
+    model.transIndex.reserve(T);
+    for (uint32_t p = 0; p < P; ++p) {
+        model.places.push_back(placeName(p));
+        model.placeIndex.emplace(model.places.back(), (int)p);
+    }
+    for (uint32_t t = 0; t < T; ++t) {
+        model.transitions.push_back(transitionName(t));
+        model.transIndex.emplace(model.transitions.back(), (int)t);
+    }
+
+    model.Pre.assign(P, vector<int>(T, 0));
+    model.Post.assign(P, vector<int>(T, 0));
+    for (uint32_t t = 0; t < T; ++t) {
+        for (uint32_t k = preRowPtr[t]; k < preRowPtr[t + 1]; ++k)
+            model.Pre[preIdx[k]][t] = preW[k];
+        for (uint32_t k = postRowPtr[t]; k < postRowPtr[t + 1]; ++k)
+            model.Post[postIdx[k]][t] = postW[k];
+    }
+
+    model.M0.assign(P, 0);
+    for (uint32_t p = 0; p < P; ++p) model.M0[p] = initialTokens(p);
+    model.arcCount = (size_t)header_->arcCount;
+    return model;
+}
+
+// ======== ENTRY POINT ========
+
+Model loadModel(const string& filename, bool useCache, bool exportDot, const string& dotPath) {
+    if (!useCache) return parsePNML(filename, exportDot, dotPath);
+
+    string resolved = resolvePath(filename);
+    string cachePath = modelCachePath(resolved);
+
+    PhaseTimer checksumPhase("[CACHE]", "checksum");
+    uint64_t checksum = fileChecksum(resolved);
+    checksumPhase.stop();
+    if (checksum == 0) return parsePNML(filename, exportDot, dotPath);  // let the parser report it
+
+    {
+        PhaseTimer loadPhase("[CACHE]", "load");
+        CompiledModel cm;
+        if (cm.open(cachePath, checksum)) {
+            Model model = cm.toModel();
+            loadPhase.stop();
+            LOG_INFO("[CACHE] Loaded compiled model: " << cachePath);
+            if (exportDot) exportDotGraph(model, dotPath);
+            Logger::get().flush();
+            return model;
+        }
+    }
+
+    Model model = parsePNML(filename, exportDot, dotPath);
+    if (saveModelCache(model, checksum, cachePath))
+        LOG_INFO("[CACHE] Wrote compiled model: " << cachePath);
+    else
+        LOG_WARN("[CACHE] Warning: cannot write " << cachePath << ", continuing without cache");
+    Logger::get().flush();
+    return model;
+}
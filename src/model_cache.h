@@ -0,0 +1,116 @@
+#ifndef MODEL_CACHE_H
+#define MODEL_CACHE_H
+
+/*
+ * model_cache.h - Binary compiled-model cache (.pnmc)
+ * Serializes a parsed Model (string table, CSR arcs, M0 bitset) next to the
+ * PNML input, keyed by a checksum of the source file, and maps it back with
+ * mmap so repeated runs skip XML parsing.
+ *
+ * File layout (native endianness, every section 8-byte aligned):
+ *   CacheHeader
+ *   uint32 strOffsets[P + T + 1]   places first, then transitions
+ *   char   strData[strBytes]
+ *   uint32 preRowPtr[T + 1],  uint32 preIdx[preNnz],  int32 preW[preNnz]
+ *   uint32 postRowPtr[T + 1], uint32 postIdx[postNnz], int32 postW[postNnz]
+ *   uint64 m0Bits[(P + 63) / 64]
+ *   uint8  m0Tokens[P]             only if CACHE_FLAG_M0_WIDE (some place > 1)
+ */
+
+#include <string>
+#include <cstdint>
+#include "utils.h"
+
+constexpr char     MODEL_CACHE_MAGIC[4] = {'P', 'N', 'M', 'C'};
+constexpr uint32_t MODEL_CACHE_VERSION  = 2;   // Bump when the parser accepts or builds models differently
+constexpr uint32_t CACHE_FLAG_M0_WIDE   = 1u << 0;
+
+struct CacheHeader {
+    char     magic[4];
+    uint32_t version;
+    uint64_t sourceChecksum;   // FNV-1a of the PNML bytes
+    uint64_t fileSize;         // Guards against truncated files
+    uint64_t arcCount;
+    uint32_t numPlaces;
+    uint32_t numTransitions;
+    uint32_t preNnz;
+    uint32_t postNnz;
+    uint32_t strBytes;
+    uint32_t flags;
+};
+
+// Read-only view of a whole file: mmap on POSIX, heap copy elsewhere
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+};
+
+// Zero-copy view over a mapped .pnmc file; pointers stay valid while it is open
+class CompiledModel {
+public:
+    // Fails (returns false) on missing file, bad magic/version/size or checksum mismatch
+    bool open(const std::string& path, uint64_t expectedChecksum);
+
+    const CacheHeader& header() const { return *header_; }
+    uint32_t numPlaces() const { return header_->numPlaces; }
+    uint32_t numTransitions() const { return header_->numTransitions; }
+
+    std::string placeName(uint32_t p) const { return name(p); }
+    std::string transitionName(uint32_t t) const { return name(header_->numPlaces + t); }
+
+    // Arcs of transition t: [rowPtr[t], rowPtr[t+1]) into idx/w
+    const uint32_t* preRowPtr = nullptr;
+    const uint32_t* preIdx = nullptr;
+    const int32_t*  preW = nullptr;
+    const uint32_t* postRowPtr = nullptr;
+    const uint32_t* postIdx = nullptr;
+    const int32_t*  postW = nullptr;
+
+    Token initialTokens(uint32_t p) const;
+
+    // Materialize the dense Model used by the engines
+    Model toModel() const;
+
+private:
+    std::string name(uint32_t i) const {
+        return std::string(strData_ + strOffsets_[i], strOffsets_[i + 1] - strOffsets_[i]);
+    }
+
+    MappedFile file_;
+    const CacheHeader* header_ = nullptr;
+    const uint32_t* strOffsets_ = nullptr;
+    const char* strData_ = nullptr;
+    const uint64_t* m0Bits_ = nullptr;
+    const uint8_t* m0Tokens_ = nullptr;
+};
+
+// FNV-1a 64-bit checksum of a file's bytes (0 if unreadable)
+uint64_t fileChecksum(const std::string& path);
+
+// Cache file used for a given PNML path: "<path>.pnmc"
+std::string modelCachePath(const std::string& pnmlPath);
+
+// Serialize model; returns false if the file cannot be written
+bool saveModelCache(const Model& model, uint64_t sourceChecksum, const std::string& cachePath);
+
+// Parse PNML, going through the .pnmc cache when useCache is set.
+// A stale or unreadable cache is silently rebuilt.
+Model loadModel(const std::string& filename,
+                bool useCache = true,
+                bool exportDot = true,
+                const std::string& dotPath = "../output/petri_net.dot");
+
+#endif // MODEL_CACHE_H
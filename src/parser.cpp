@@ -1,8 +1,8 @@
 #include <iostream>
 #include <fstream>
-#include <set>
 #include "parser.h"
 #include "tinyxml2.h"
+#include "logger.h"
 
 using namespace tinyxml2;
 using namespace std;
@@ -43,6 +43,37 @@ bool createDirectoryIfNotExists(const string& path) {
     return false;
 }
 
+// Interns element ids: O(1) duplicate detection and id -> index lookup
+struct IdTable {
+    vector<string> ids;
+    unordered_map<string, int> index;
+
+    // Returns false if id was already interned
+    bool intern(const char* id) {
+        auto ins = index.emplace(id, (int)ids.size());
+        if (!ins.second) return false;
+        ids.push_back(ins.first->first);
+        return true;
+    }
+
+    // Sort ids for a consistent ordering; remap[old] = new index
+    void sortIds(vector<int>& remap) {
+        vector<int> order(ids.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = (int)i;
+        sort(order.begin(), order.end(),
+             [this](int a, int b) { return ids[a] < ids[b]; });
+
+        remap.assign(ids.size(), 0);
+        vector<string> sorted(ids.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            remap[order[i]] = (int)i;
+            sorted[i] = move(ids[order[i]]);
+        }
+        ids = move(sorted);
+        for (auto& kv : index) kv.second = remap[kv.second];
+    }
+};
+
 // ======== MAIN PARSER FUNCTION ========
 
 Model parsePNML(const string& filename, bool exportDot, const string& dotPath)
@@ -51,11 +82,13 @@ Model parsePNML(const string& filename, bool exportDot, const string& dotPath)
 
     // Resolve file path
     string resolvedFilename = resolvePath(filename);
-    cout << "[PARSER] Opening file: " << resolvedFilename << endl;
+    LOG_INFO("[PARSER] Opening file: " << resolvedFilename);
 
+    PhaseTimer loadPhase("[PARSER]", "load-xml");
     if (doc.LoadFile(resolvedFilename.c_str()) != XML_SUCCESS) {
         throw runtime_error("Cannot open PNML file: " + resolvedFilename);
     }
+    loadPhase.stop();
 
     // ==========================
     // 1. Đọc root PNML
@@ -67,24 +100,23 @@ Model parsePNML(const string& filename, bool exportDot, const string& dotPath)
     XMLElement* net = pnml->FirstChildElement("net");
     if (!net) throw runtime_error("<net> missing!");
 
-    cout << "[PARSER] Found <pnml> and <net> elements" << endl;
-
     // Xử lý <page> element nếu có
     XMLElement* page = net->FirstChildElement("page");
     if (page) {
-        cout << "[PARSER] Found <page> element, using it for parsing" << endl;
+        LOG_DEBUG("[PARSER] Found <page> element, using it for parsing");
         net = page;
     } else {
-        cout << "[PARSER] No <page> element, using <net> directly" << endl;
+        LOG_DEBUG("[PARSER] No <page> element, using <net> directly");
     }
 
     // ==========================
     // 2. Thu thập place, trans
     // ==========================
 
-    vector<string> placeIds;
-    vector<string> transIds;
-    unordered_map<string,int> initialMarks;
+    PhaseTimer collectPhase("[PARSER]", "collect-ids");
+    IdTable placeTable;
+    IdTable transTable;
+    vector<pair<int, int>> initialMarks;  // (place index before sort, tokens)
 
     // ---- place ----
     for (XMLElement* p = net->FirstChildElement("place"); p; p = p->NextSiblingElement("place"))
@@ -92,15 +124,11 @@ Model parsePNML(const string& filename, bool exportDot, const string& dotPath)
         const char* id = p->Attribute("id");
         if (!id) throw runtime_error("place missing id!");
 
-        string sid = id;
-
-        cout << "[PARSER] Found place: " << sid << endl;
+        LOG_DEBUG("[PARSER] Found place: " << id);
 
         // check duplicate
-        if (find(placeIds.begin(), placeIds.end(), sid) != placeIds.end())
-            throw runtime_error("Duplicate place id: " + sid);
-
-        placeIds.push_back(sid);
+        if (!placeTable.intern(id))
+            throw runtime_error("Duplicate place id: " + string(id));
 
         // check initial marking
         XMLElement* im = p->FirstChildElement("initialMarking");
@@ -108,8 +136,11 @@ Model parsePNML(const string& filename, bool exportDot, const string& dotPath)
             XMLElement* val = im->FirstChildElement("text");
             if (val && val->GetText()) {
                 int m = stoi(val->GetText());
-                initialMarks[sid] = m;
-                cout << "[PARSER]   - Initial marking: " << m << endl;
+                if (m < 0 || m > MAX_TOKENS)
+                    throw runtime_error("Initial marking of place " + string(id) + " out of range 0.."
+                                        + to_string(MAX_TOKENS));
+                initialMarks.emplace_back((int)placeTable.ids.size() - 1, m);
+                LOG_DEBUG("[PARSER]   - Initial marking: " << m);
             }
         }
     }
@@ -120,55 +151,50 @@ Model parsePNML(const string& filename, bool exportDot, const string& dotPath)
         const char* id = t->Attribute("id");
         if (!id) throw runtime_error("transition missing id!");
 
-        string sid = id;
-
-        cout << "[PARSER] Found transition: " << sid << endl;
+        LOG_DEBUG("[PARSER] Found transition: " << id);
 
-        if (find(transIds.begin(), transIds.end(), sid) != transIds.end())
-            throw runtime_error("Duplicate transition id: " + sid);
-
-        transIds.push_back(sid);
+        if (!transTable.intern(id))
+            throw runtime_error("Duplicate transition id: " + string(id));
     }
 
     // sort để đảm bảo thứ tự consistent
-    sort(placeIds.begin(), placeIds.end());
-    sort(transIds.begin(), transIds.end());
+    vector<int> placeRemap, transRemap;
+    placeTable.sortIds(placeRemap);
+    transTable.sortIds(transRemap);
+    collectPhase.stop();
 
     // ==========================
     // 3. Tạo Model
     // ==========================
 
+    PhaseTimer buildPhase("[PARSER]", "build-matrices");
     Model model;
-    model.places = placeIds;
-    model.transitions = transIds;
+    model.places = move(placeTable.ids);
+    model.transitions = move(transTable.ids);
+    model.placeIndex = move(placeTable.index);
+    model.transIndex = move(transTable.index);
 
-    size_t P = placeIds.size();
-    size_t T = transIds.size();
+    size_t P = model.places.size();
+    size_t T = model.transitions.size();
 
     // Khởi tạo ma trận Pre và Post
     model.Pre.assign(P, vector<int>(T, 0));
     model.Post.assign(P, vector<int>(T, 0));
     model.M0.assign(P, 0);
 
-    // Tạo mapping ID → index
-    for (size_t i = 0; i < P; i++) model.placeIndex[placeIds[i]] = i;
-    for (size_t j = 0; j < T; j++) model.transIndex[transIds[j]] = j;
-
     // ==========================
     // 4. Xử lý initial marking
     // ==========================
 
-    for (auto& kv : initialMarks)
-    {
-        if (!model.placeIndex.count(kv.first))
-            throw runtime_error("initialMarking refers to unknown place: " + kv.first);
-        model.M0[model.placeIndex[kv.first]] = kv.second;
-    }
+    for (auto& im : initialMarks)
+        model.M0[placeRemap[im.first]] = im.second;
+    buildPhase.stop();
 
     // ==========================
     // 5. Đọc <arc>
     // ==========================
 
+    PhaseTimer arcPhase("[PARSER]", "arcs");
     size_t arcCount = 0;
 
     for (XMLElement* a = net->FirstChildElement("arc"); a; a = a->NextSiblingElement("arc"))
@@ -183,7 +209,7 @@ Model parsePNML(const string& filename, bool exportDot, const string& dotPath)
 
         string s = sid, t = tid;
 
-        cout << "[PARSER] Found arc: " << s << " -> " << t << endl;
+        LOG_DEBUG("[PARSER] Found arc: " << s << " -> " << t);
 
         int w = 1; // default weight
         XMLElement* ins = a->FirstChildElement("inscription");
@@ -191,28 +217,31 @@ Model parsePNML(const string& filename, bool exportDot, const string& dotPath)
             XMLElement* val = ins->FirstChildElement("text");
             if (val && val->GetText()) {
                 w = stoi(val->GetText());
-                cout << "[PARSER]   - Weight: " << w << endl;
+                if (w < 1 || w > MAX_TOKENS)
+                    throw runtime_error("Weight of arc " + s + " -> " + t + " out of range 1.."
+                                        + to_string(MAX_TOKENS));
+                LOG_DEBUG("[PARSER]   - Weight: " << w);
             }
         }
 
-        bool sIsPlace = model.placeIndex.count(s);
-        bool tIsPlace = model.placeIndex.count(t);
-        bool sIsTrans = model.transIndex.count(s);
-        bool tIsTrans = model.transIndex.count(t);
+        // Một lần lookup cho mỗi đầu mút
+        auto sPlace = model.placeIndex.find(s);
+        auto tTrans = model.transIndex.find(t);
 
-        if (sIsPlace && tIsTrans) {
+        if (sPlace != model.placeIndex.end() && tTrans != model.transIndex.end()) {
             // Pre arc: place → transition
-            int p = model.placeIndex[s];
-            int tt = model.transIndex[t];
-            model.Pre[p][tt] = w;
-            cout << "[PARSER]   - Added Pre[" << p << "][" << tt << "] = " << w << endl;
+            model.Pre[sPlace->second][tTrans->second] = w;
+            LOG_DEBUG("[PARSER]   - Added Pre[" << sPlace->second << "][" << tTrans->second << "] = " << w);
+            continue;
         }
-        else if (sIsTrans && tIsPlace) {
+
+        auto sTrans = model.transIndex.find(s);
+        auto tPlace = model.placeIndex.find(t);
+
+        if (sTrans != model.transIndex.end() && tPlace != model.placeIndex.end()) {
             // Post arc: transition → place
-            int p = model.placeIndex[t];
-            int tt = model.transIndex[s];
-            model.Post[p][tt] = w;
-            cout << "[PARSER]   - Added Post[" << p << "][" << tt << "] = " << w << endl;
+            model.Post[tPlace->second][sTrans->second] = w;
+            LOG_DEBUG("[PARSER]   - Added Post[" << tPlace->second << "][" << sTrans->second << "] = " << w);
         }
         else {
             throw runtime_error("Invalid arc: must be place→transition or transition→place");
@@ -220,63 +249,13 @@ Model parsePNML(const string& filename, bool exportDot, const string& dotPath)
     }
 
     model.arcCount = arcCount;
+    arcPhase.stop();
 
     // ==========================
     // 6. Export DOT (optional)
     // ==========================
 
-    if (exportDot) {
-        cout << "[PARSER] Exporting DOT to: " << dotPath << endl;
-        
-        // Tạo thư mục nếu chưa tồn tại
-        createDirectoryIfNotExists(dotPath);
-        
-        ofstream out(dotPath);
-        if (!out) {
-            throw runtime_error("Cannot create DOT file: " + dotPath);
-        }
-
-        out << "digraph PN {\n";
-        out << " rankdir=LR;\n";
-        out << " node [fontname=\"Arial\"];\n\n";
-
-        // Places (với initial marking)
-        for (size_t i = 0; i < P; i++) {
-            out << "  \"" << model.places[i] << "\" [shape=circle";
-            if (model.M0[i] > 0) {
-                out << " style=filled fillcolor=lightgray";
-            }
-            out << " label=\"" << model.places[i];
-            if (model.M0[i] > 0) {
-                out << "\\n(" << (int)model.M0[i] << ")";
-            }
-            out << "\"];\n";
-        }
-
-        // Transitions
-        for (size_t j = 0; j < T; j++)
-            out << "  \"" << model.transitions[j] << "\" [shape=box label=\"" << model.transitions[j] << "\"];\n";
-
-        out << "\n";
-
-        // Pre arcs (place → transition)
-        for (size_t p = 0; p < P; p++)
-            for (size_t t = 0; t < T; t++)
-                if (model.Pre[p][t] > 0)
-                    out << "  \"" << model.places[p] << "\" -> \"" << model.transitions[t]
-                        << "\" [label=\"" << model.Pre[p][t] << "\"];\n";
-
-        // Post arcs (transition → place)
-        for (size_t p = 0; p < P; p++)
-            for (size_t t = 0; t < T; t++)
-                if (model.Post[p][t] > 0)
-                    out << "  \"" << model.transitions[t] << "\" -> \"" << model.places[p]
-                        << "\" [label=\"" << model.Post[p][t] << "\"];\n";
-
-        out << "}\n";
-        out.close();
-        cout << "[PARSER] DOT export completed" << endl;
-    }
+    if (exportDot) exportDotGraph(model, dotPath);
 
     // ==========================
     // 7. Validation và Logging
@@ -287,14 +266,71 @@ Model parsePNML(const string& filename, bool exportDot, const string& dotPath)
         throw runtime_error("Model validation failed");
     }
 
-    cout << "[PARSER] PNML parsed successfully: "
-         << "P=" << P << ", T=" << T << ", A=" << arcCount << endl;
+    LOG_INFO("[PARSER] PNML parsed successfully: "
+             << "P=" << P << ", T=" << T << ", A=" << arcCount);
+    Logger::get().flush();
 
     return model;
 }
 
 // ======== UTILITY FUNCTIONS ========
 
+void exportDotGraph(const Model& model, const string& dotPath) {
+    const size_t P = model.places.size();
+    const size_t T = model.transitions.size();
+
+    PhaseTimer dotPhase("[PARSER]", "export-dot");
+    LOG_INFO("[PARSER] Exporting DOT to: " << dotPath);
+
+    // Tạo thư mục nếu chưa tồn tại
+    createDirectoryIfNotExists(dotPath);
+
+    ofstream out(dotPath);
+    if (!out) {
+        throw runtime_error("Cannot create DOT file: " + dotPath);
+    }
+
+    out << "digraph PN {\n";
+    out << " rankdir=LR;\n";
+    out << " node [fontname=\"Arial\"];\n\n";
+
+    // Places (với initial marking)
+    for (size_t i = 0; i < P; i++) {
+        out << "  \"" << model.places[i] << "\" [shape=circle";
+        if (model.M0[i] > 0) {
+            out << " style=filled fillcolor=lightgray";
+        }
+        out << " label=\"" << model.places[i];
+        if (model.M0[i] > 0) {
+            out << "\\n(" << (int)model.M0[i] << ")";
+        }
+        out << "\"];\n";
+    }
+
+    // Transitions
+    for (size_t j = 0; j < T; j++)
+        out << "  \"" << model.transitions[j] << "\" [shape=box label=\"" << model.transitions[j] << "\"];\n";
+
+    out << "\n";
+
+    // Pre arcs (place → transition)
+    for (size_t p = 0; p < P; p++)
+        for (size_t t = 0; t < T; t++)
+            if (model.Pre[p][t] > 0)
+                out << "  \"" << model.places[p] << "\" -> \"" << model.transitions[t]
+                    << "\" [label=\"" << model.Pre[p][t] << "\"];\n";
+
+    // Post arcs (transition → place)
+    for (size_t p = 0; p < P; p++)
+        for (size_t t = 0; t < T; t++)
+            if (model.Post[p][t] > 0)
+                out << "  \"" << model.transitions[t] << "\" -> \"" << model.places[p]
+                    << "\" [label=\"" << model.Post[p][t] << "\"];\n";
+
+    out << "}\n";
+    out.close();
+}
+
 void printModelSummary(const Model& model) {
     cout << "=== PETRI NET MODEL SUMMARY ===" << endl;
     cout << "Places (" << model.places.size() << "): ";
@@ -324,23 +360,21 @@ void printModelSummary(const Model& model) {
 bool validateModel(const Model& model) {
     // Kiểm tra cơ bản
     if (model.places.empty()) {
-        cerr << "[VALIDATION] Error: No places found" << endl;
+        LOG_WARN("[VALIDATION] Error: No places found");
         return false;
     }
     
     if (model.M0.size() != model.places.size()) {
-        cerr << "[VALIDATION] Error: M0 size doesn't match places count" << endl;
+        LOG_WARN("[VALIDATION] Error: M0 size doesn't match places count");
         return false;
     }
     
-    // Kiểm tra 1-safe property cho M0 (cảnh báo)
-    for (size_t i = 0; i < model.M0.size(); ++i) {
-        if (model.M0[i] > 1) {
-            cout << "[VALIDATION] Warning: Place " << model.places[i] 
-                 << " has " << model.M0[i] << " tokens (may not be 1-safe)" << endl;
-        }
-    }
+    // Net không 1-safe vẫn hợp lệ (k-bounded), chỉ ghi log
+    int bound = initialTokenBound(model);
+    if (bound > 1)
+        LOG_INFO("[VALIDATION] Net is not 1-safe (M0 / arc weights up to " << bound
+                 << "), using the k-bounded encoding");
     
-    cout << "[VALIDATION] Model validation passed" << endl;
+    LOG_INFO("[VALIDATION] Model validation passed");
     return true;
 }
\ No newline at end of file
@@ -14,6 +14,12 @@ Model parsePNML(const std::string& filename,
                 bool exportDot = true,
                 const std::string& dotPath = "../output/petri_net.dot");
 
+// Write GraphViz DOT of the net (places, transitions, weighted arcs)
+void exportDotGraph(const Model& model, const std::string& dotPath);
+
+// Return filename, or "../" + filename if only that one exists
+std::string resolvePath(const std::string& filename);
+
 void printModelSummary(const Model& model);
 bool validateModel(const Model& model);
 
@@ -1,12 +1,507 @@
 #include "reachability.h"
+#include "logger.h"
 #include <queue>        // cho BFS
 #include <stack>        // cho DFS
 #include <unordered_set>
 #include <iostream>
+#include <cmath>
+#include <cstring>
+#include <cstdio>
+#include <stdexcept>
+#include <memory>
+#include <filesystem>
+#include <map>
+#include <climits>
 
 using namespace std;
 
-ExplicitReachability::ExplicitReachability(const Model &model) : petri_net(model) {}
+namespace {
+
+// Trộn bit của hash (splitmix64 finalizer)
+uint64_t mix64(uint64_t x) {
+    x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27; x *= 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Tập marking đã thăm. EXACT giữ nguyên marking; HASH_COMPACT giữ fingerprint
+// (bảng địa chỉ mở, 0 = ô trống); BITSTATE là Bloom filter với k bit mỗi marking
+// (double hashing h1 + i*h2). Hai kiểu xấp xỉ cộng dồn số marking bị bỏ sót kỳ vọng:
+// marking mới bị coi là đã thăm khi fingerprint trùng / cả k bit đã bật.
+class VisitedSet {
+public:
+    enum Outcome { SEEN, ADDED, FULL };
+
+    VisitedSet(const ReachOptions &opts) : kind(opts.store) {
+        if (kind == StateStore::BITSTATE) {
+            int bits = opts.bitsPerState > 0 ? opts.bitsPerState : 16;
+            size_t expected = opts.maxStates ? opts.maxStates : (size_t)1 << 24;
+            numBits = max<uint64_t>((uint64_t)bits * expected, 64);
+            filter.assign((numBits + 63) / 64, 0);
+            hashes = max(1, opts.hashFunctions);
+        } else {
+            cap = opts.maxStates;
+            fpBits = opts.bitsPerState > 0 ? min(opts.bitsPerState, 64) : 64;
+            if (kind == StateStore::HASH_COMPACT) table.assign(1024, 0);
+        }
+    }
+
+    Outcome insert(const Marking &M) {
+        if (kind == StateStore::EXACT) {
+            if (exact.count(M)) return SEEN;
+            if (cap && exact.size() >= cap) return FULL;
+            exact.insert(M);
+            return ADDED;
+        }
+        uint64_t h = fnv1a(M.data(), M.size());
+        return kind == StateStore::BITSTATE ? insertBits(h) : insertFingerprint(mix64(h) >> (64 - fpBits));
+    }
+
+    size_t size() const { return kind == StateStore::EXACT ? exact.size() : count; }
+    double expectedOmissions() const { return omissions; }
+    double bitsPerState() const { return count ? (double)numBits / count : 0; }
+
+private:
+    Outcome insertBits(uint64_t h1) {
+        uint64_t h2 = mix64(h1) | 1;
+        bool fresh = false;
+        for (int i = 0; i < hashes; ++i) {
+            uint64_t b = (h1 + i * h2) % numBits;
+            uint64_t &word = filter[b / 64];
+            uint64_t bit = 1ULL << (b % 64);
+            if (!(word & bit)) { word |= bit; ++setBits; fresh = true; }
+        }
+        if (!fresh) return SEEN;
+        // Xác suất một marking mới khác rơi đúng vào các bit đã bật lúc này
+        omissions += pow((double)setBits / numBits, hashes);
+        ++count;
+        return ADDED;
+    }
+
+    Outcome insertFingerprint(uint64_t f) {
+        if (f == 0) {
+            if (hasZero) return SEEN;
+        } else {
+            for (size_t i = slot(f); table[i]; i = (i + 1) & (table.size() - 1))
+                if (table[i] == f) return SEEN;
+        }
+        if (cap && count >= cap) return FULL;
+        omissions += ldexp((double)count, -fpBits);  // Trùng một trong count fingerprint đã có
+        ++count;
+        if (f == 0) { hasZero = true; return ADDED; }
+        if (2 * (count + 1) > table.size()) grow();
+        size_t i = slot(f);
+        while (table[i]) i = (i + 1) & (table.size() - 1);
+        table[i] = f;
+        return ADDED;
+    }
+
+    size_t slot(uint64_t f) const { return (f * 0x9E3779B97F4A7C15ULL) >> (64 - tableBits); }
+
+    void grow() {
+        vector<uint64_t> old(table.size() * 2, 0);
+        old.swap(table);
+        ++tableBits;
+        for (uint64_t f : old) {
+            if (!f) continue;
+            size_t i = slot(f);
+            while (table[i]) i = (i + 1) & (table.size() - 1);
+            table[i] = f;
+        }
+    }
+
+    StateStore kind;
+    size_t cap = 0, count = 0;
+    double omissions = 0;
+    unordered_set<Marking, MarkingHash> exact;
+    // HASH_COMPACT
+    int fpBits = 64, tableBits = 10;
+    vector<uint64_t> table;
+    bool hasZero = false;
+    // BITSTATE
+    vector<uint64_t> filter;
+    uint64_t numBits = 0, setBits = 0;
+    int hashes = 1;
+};
+
+// Kết quả của kiểu lưu xấp xỉ: xác suất bỏ sót ít nhất một marking (Poisson)
+void reportOmissions(const VisitedSet &visited, const ReachOptions &opts, ReachResult &result) {
+    if (opts.store == StateStore::EXACT) return;
+    result.omissionProb = -expm1(-visited.expectedOmissions());
+    if (opts.store == StateStore::BITSTATE)
+        LOG_INFO("[REACH] Bitstate: " << visited.bitsPerState() << " filter bits per marking, "
+                 << opts.hashFunctions << " hash functions");
+    LOG_INFO("[REACH] Expected missed markings: " << visited.expectedOmissions()
+             << ", P(any missed) = " << result.omissionProb);
+}
+
+
+// ======== DISK BFS ========
+// Marking trên đĩa là bản ghi cố định W byte (dạng stored(M)); mọi file đều
+// được sắp xếp theo memcmp và đọc/ghi tuần tự theo khối lớn.
+
+const size_t IO_BLOCK = (size_t)4 << 20;
+
+class RecordWriter {
+public:
+    RecordWriter(const string &path, size_t width, bool append = false) : path(path), width(width) {
+        out = fopen(path.c_str(), append ? "ab" : "wb");
+        if (!out) throw runtime_error("Cannot write BFS file: " + path);
+        buf.reserve(IO_BLOCK);
+    }
+    ~RecordWriter() { if (out) fclose(out); }
+
+    void write(const uint8_t *rec) {
+        buf.insert(buf.end(), rec, rec + width);
+        if (buf.size() >= IO_BLOCK) flush();
+        ++count;
+    }
+    void close() {
+        flush();
+        bool ok = fclose(out) == 0;
+        out = nullptr;
+        if (!ok) throw runtime_error("Cannot write BFS file: " + path);
+    }
+    size_t records() const { return count; }
+    // Đẩy mọi bản ghi đã nhận xuống file (checkpoint)
+    void sync() {
+        flush();
+        if (fflush(out) != 0) throw runtime_error("Cannot write BFS file: " + path);
+    }
+
+private:
+    void flush() {
+        if (!buf.empty() && fwrite(buf.data(), 1, buf.size(), out) != buf.size())
+            throw runtime_error("Cannot write BFS file: " + path);
+        buf.clear();
+    }
+    string path;
+    size_t width, count = 0;
+    FILE *out;
+    vector<uint8_t> buf;
+};
+
+class RecordReader {
+public:
+    RecordReader(const string &path, size_t width) : width(width) {
+        in = fopen(path.c_str(), "rb");
+        if (!in) throw runtime_error("Cannot read BFS file: " + path);
+        buf.resize(IO_BLOCK / width * width);
+    }
+    RecordReader(RecordReader &&o) noexcept : width(o.width), in(o.in), buf(move(o.buf)), pos(o.pos), len(o.len) {
+        o.in = nullptr;
+    }
+    ~RecordReader() { if (in) fclose(in); }
+
+    // Sang bản ghi kế tiếp; false khi hết file
+    bool next() {
+        pos += width;
+        if (pos >= len) {
+            len = fread(buf.data(), 1, buf.size(), in) / width * width;
+            pos = 0;
+        }
+        return pos < len;
+    }
+    const uint8_t *record() const { return buf.data() + pos; }
+
+private:
+    size_t width;
+    FILE *in;
+    vector<uint8_t> buf;
+    size_t pos = 0, len = 0;
+};
+
+// Gom successor trong bộ nhớ; đầy thì sắp xếp, bỏ trùng và ghi thành một run
+class RunSpiller {
+public:
+    RunSpiller(const string &prefix, size_t width, size_t capacity)
+        : prefix(prefix), width(width), capacity(capacity) { buf.reserve(capacity * width); }
+
+    void add(const uint8_t *rec) {
+        buf.insert(buf.end(), rec, rec + width);
+        if (buf.size() >= capacity * width) spill();
+    }
+    // Ghi phần còn lại; trả về đường dẫn các run
+    const vector<string> &finish() {
+        if (!buf.empty()) spill();
+        return runs;
+    }
+
+private:
+    void spill() {
+        size_t n = buf.size() / width;
+        vector<size_t> order(n);  // Bộ đệm có thể vượt 2^32 bản ghi
+        for (size_t i = 0; i < n; ++i) order[i] = i;
+        const uint8_t *base = buf.data();
+        size_t w = width;
+        sort(order.begin(), order.end(), [base, w](size_t a, size_t b) {
+            return memcmp(base + a * w, base + b * w, w) < 0;
+        });
+        runs.push_back(prefix + "run" + to_string(runs.size()));
+        RecordWriter out(runs.back(), width);
+        const uint8_t *last = nullptr;
+        for (size_t i : order) {
+            const uint8_t *rec = base + i * width;
+            if (!last || memcmp(last, rec, width) != 0) out.write(rec);
+            last = rec;
+        }
+        out.close();
+        buf.clear();
+    }
+    string prefix;
+    size_t width, capacity;
+    vector<uint8_t> buf;
+    vector<string> runs;
+};
+
+// ======== CHECKPOINTS ========
+// Trạng thái của một checkpoint là một dòng "<magic> <version> <key> <số>..."
+// ghi ra file tạm rồi rename: bị ngắt giữa chừng thì checkpoint trước vẫn còn.
+
+const int CHECKPOINT_VERSION = 1;
+
+string checkpointPath(const string &dir, const char *kind, uint64_t key) {
+    char name[48];
+    snprintf(name, sizeof(name), "%s-%016llx", kind, (unsigned long long)key);
+    string path = dir;
+    if (!path.empty() && path.back() != '/' && path.back() != '\\') path += '/';
+    return path + name;
+}
+
+void saveCheckpointState(const string &path, const char *magic, uint64_t key, const vector<double> &fields) {
+    string tmpPath = path + ".tmp";
+    FILE *out = fopen(tmpPath.c_str(), "w");
+    bool ok = out != nullptr;
+    if (ok) {
+        fprintf(out, "%s %d %016llx", magic, CHECKPOINT_VERSION, (unsigned long long)key);
+        for (double f : fields) fprintf(out, " %.17g", f);
+        fputc('\n', out);
+        ok = fclose(out) == 0;
+    }
+    if (!ok || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        remove(tmpPath.c_str());
+        LOG_WARN("[REACH] Cannot write checkpoint " << path);
+    }
+}
+
+// false khi thiếu file, khác phiên bản/khóa hoặc hỏng (fields không đổi)
+bool loadCheckpointState(const string &path, const char *magic, uint64_t key, vector<double> &fields) {
+    FILE *in = fopen(path.c_str(), "r");
+    if (!in) return false;
+    char savedMagic[16];
+    int version = 0;
+    unsigned long long savedKey = 0;
+    bool ok = fscanf(in, "%15s %d %llx", savedMagic, &version, &savedKey) == 3
+              && string(savedMagic) == magic && version == CHECKPOINT_VERSION && savedKey == key;
+    vector<double> values(fields.size());
+    for (size_t i = 0; ok && i < values.size(); ++i) ok = fscanf(in, "%lf", &values[i]) == 1;
+    fclose(in);
+    if (ok) fields = values;
+    return ok;
+}
+
+// Checkpoint của BFS trong bộ nhớ. Marking mới được ghi nối vào log theo thứ tự
+// thêm vào visited, cũng là thứ tự hàng đợi, nên frontier luôn là đoạn cuối
+// log[expanded..logged). Checkpoint chỉ flush log và ghi lại các con số tại
+// ranh giới gần nhất giữa hai lần mở rộng; resume cắt phần log ghi sau đó.
+class BfsCheckpoint {
+public:
+    BfsCheckpoint(const ReachOptions &opts, uint64_t key, size_t places)
+        : dir(opts.checkpointDir), key(key), places(places), width(max<size_t>(places, 1)),
+          interval(opts.checkpointSec), rec(width, 0) {
+        if (dir.empty()) return;
+        statePath = checkpointPath(dir, "explicit", key);
+        logPath = statePath + ".log";
+    }
+
+    bool enabled() const { return !dir.empty(); }
+
+    // Nạp lại visited/hàng đợi qua add(M, trong frontier); false: không có checkpoint khớp
+    template <class Add>
+    bool resume(Add add, size_t &expanded, size_t &orbitStates, bool &orbitsKnown) {
+        vector<double> f(4);
+        if (!enabled() || !loadCheckpointState(statePath, "PNEXPL", key, f)) return false;
+        size_t n = (size_t)f[0];
+        error_code ec;
+        filesystem::resize_file(logPath, n * width, ec);  // Bỏ phần ghi sau checkpoint
+        if (ec) return false;
+        RecordReader in(logPath, width);
+        for (size_t i = 0; i < n && in.next(); ++i)
+            add(Marking(in.record(), in.record() + places), i >= (size_t)f[1]);
+        log.reset(new RecordWriter(logPath, width, true));
+        logged = doneLogged = n;
+        expanded = doneExpanded = (size_t)f[1];
+        orbitStates = doneOrbits = (size_t)f[2];
+        orbitsKnown = doneKnown = f[3] != 0;
+        LOG_INFO("[REACH] Resumed BFS: " << n << " markings, " << n - expanded << " in the frontier");
+        return true;
+    }
+
+    void start() {
+        if (enabled()) log.reset(new RecordWriter(logPath, width));
+    }
+
+    void append(const Marking &M) {
+        if (!log) return;
+        copy(M.begin(), M.end(), rec.begin());
+        log->write(rec.data());
+        ++logged;
+    }
+
+    // Vừa mở rộng xong marking thứ expanded; lưu khi đến hạn (đồng hồ xem mỗi 1024 lần)
+    void boundary(size_t expanded, size_t orbitStates, bool orbitsKnown) {
+        if (!log) return;
+        doneLogged = logged;
+        doneExpanded = expanded;
+        doneOrbits = orbitStates;
+        doneKnown = orbitsKnown;
+        if (expanded % 1024 == 0 && getTimeSec() - lastSave >= interval) save();
+    }
+
+    // Hoàn tất: xóa checkpoint; dở dang: lưu ranh giới cuối để chạy tiếp
+    void finish(bool complete) {
+        if (!log) return;
+        if (!complete) {
+            save();
+            log.reset();
+            return;
+        }
+        log.reset();
+        remove(statePath.c_str());
+        remove(logPath.c_str());
+    }
+
+private:
+    void save() {
+        log->sync();
+        saveCheckpointState(statePath, "PNEXPL", key,
+                            {(double)doneLogged, (double)doneExpanded, (double)doneOrbits, (double)doneKnown});
+        lastSave = getTimeSec();
+    }
+
+    string dir, statePath, logPath;
+    uint64_t key;
+    size_t places, width;
+    double interval, lastSave = getTimeSec();
+    vector<uint8_t> rec;
+    unique_ptr<RecordWriter> log;
+    size_t logged = 0, doneLogged = 0, doneExpanded = 0, doneOrbits = 0;
+    bool doneKnown = true;
+};
+
+// Trộn k run đã sắp xếp thành một dòng tăng dần không trùng
+class RunMerger {
+public:
+    RunMerger(const vector<string> &runs, size_t width) : width(width), heap(Greater{this}) {
+        for (const string &path : runs) {
+            readers.emplace_back(path, width);
+            if (readers.back().next()) heap.push(readers.size() - 1);
+        }
+    }
+    bool next() {
+        while (!heap.empty()) {
+            size_t i = heap.top();
+            heap.pop();
+            current.assign(readers[i].record(), readers[i].record() + width);
+            if (readers[i].next()) heap.push(i);
+            if (!started || current != previous) {
+                started = true;
+                previous = current;
+                return true;
+            }
+        }
+        return false;
+    }
+    const uint8_t *record() const { return current.data(); }
+
+private:
+    struct Greater {
+        const RunMerger *m;
+        bool operator()(size_t a, size_t b) const {
+            return memcmp(m->readers[a].record(), m->readers[b].record(), m->width) > 0;
+        }
+    };
+    size_t width;
+    vector<RecordReader> readers;
+    priority_queue<size_t, vector<size_t>, Greater> heap;
+    vector<uint8_t> current, previous;
+    bool started = false;
+};
+
+}
+
+ExplicitReachability::ExplicitReachability(const Model &model, const ReachOptions &opts)
+    : petri_net(model), opts(opts), store(model.places.size(), opts.invariants),
+      growth(model.transitions.size()) {
+    if (store.implied())
+        LOG_INFO("[REACH] Storing " << store.size() << " of " << model.places.size()
+                 << " places per marking, " << store.implied() << " implied by P-invariants");
+    for (size_t p = 0; p < model.places.size(); ++p)
+        for (size_t t = 0; t < model.transitions.size(); ++t)
+            if (model.Post[p][t] > model.Pre[p][t])
+                growth[t].push_back({(int)p, model.Post[p][t] - model.Pre[p][t]});
+    if (opts.sweep) {
+        progressWeights = opts.progress;
+        if (progressWeights.size() != model.places.size()) {
+            if (!progressWeights.empty())
+                LOG_WARN("[REACH] Progress measure has " << progressWeights.size() << " weights for "
+                         << model.places.size() << " places, deriving one from the net");
+            progressWeights = progressMeasure(model);
+        }
+    }
+}
+
+// Checkpoint chỉ hợp lệ khi marking được lưu cùng một dạng: cùng net, cùng cơ sở
+// P-invariant, cùng nhóm đối xứng và cùng kiểu visited set
+uint64_t ExplicitReachability::checkpointKey() const {
+    uint64_t h = modelHash(petri_net);
+    for (const auto &inv : opts.invariants)
+        h = fnv1a(inv.terms.data(), inv.terms.size() * sizeof(inv.terms[0]), h);
+    for (const auto &g : opts.symmetry.placeGenerators())
+        h = fnv1a(g.data(), g.size() * sizeof(int), h);
+    int storeParams[3] = {(int)opts.store, opts.bitsPerState, opts.hashFunctions};
+    h = fnv1a(storeParams, sizeof(storeParams), h);
+    uint64_t expected = opts.store == StateStore::BITSTATE ? opts.maxStates : 0;  // Kích thước filter
+    return fnv1a(&expected, sizeof(expected), h);
+}
+
+// Token là uint8_t: vượt MAX_TOKENS thì marking bị tràn, coi như mạng không bị chặn
+bool ExplicitReachability::overflows(const Marking &M, int t) const {
+    for (const auto &g : growth[t])
+        if (M[g.first] + g.second > MAX_TOKENS) {
+            LOG_WARN("[REACH] Place " << petri_net.places[g.first] << " exceeds "
+                     << MAX_TOKENS << " tokens, stopping (net may be unbounded)");
+            return true;
+        }
+    return false;
+}
+
+// Marking đại diện của quỹ đạo (nếu có đối xứng) ở dạng nén; orbit = kích thước quỹ đạo (0: không biết)
+Marking ExplicitReachability::stored(Marking M, size_t &orbit, long long *progress) const {
+    orbit = 1;
+    if (!opts.symmetry.trivial()) M = opts.symmetry.canonical(M, &orbit);
+    if (progress) {
+        *progress = 0;
+        for (size_t p = 0; p < M.size(); ++p) *progress += progressWeights[p] * M[p];
+    }
+    return store.compress(move(M));
+}
+
+// Một marking trong visited tốn: node của unordered_set (~56 byte) + bucket (8)
+// + dữ liệu vector (P byte + ~16 overhead malloc); frontier giữ thêm một bản sao.
+// Với P-invariant chỉ các place cơ sở được lưu (storedPlaces byte thay cho P)
+// HASH_COMPACT: fingerprint 8 byte, bảng lấp tối đa 1/2 (sau khi nhân đôi có thể 1/4)
+// => ~32 byte, cộng bản sao trên frontier. BITSTATE: toàn bộ bộ nhớ cho filter
+size_t explicitStateCap(const Model &model, double memLimitMB, size_t storedPlaces,
+                        StateStore store, int bitsPerState) {
+    if (memLimitMB <= 0) return 0;
+    size_t bytes = storedPlaces ? storedPlaces : model.places.size();
+    double budget = memLimitMB * 1024 * 1024;
+    if (store == StateStore::BITSTATE)
+        return max<size_t>((size_t)(budget * 8 / (bitsPerState > 0 ? bitsPerState : 16)), 1);
+    double perState = store == StateStore::HASH_COMPACT ? bytes + 32.0 + 40.0 : 2.0 * bytes + 128.0;
+    return max<size_t>((size_t)(budget / perState), 1);
+}
 
 
 //BFS
@@ -17,29 +512,57 @@ ReachResult ExplicitReachability::computeBFS() {
     double m0 = getMemoryMB();
 
     queue<Marking> q;
-    unordered_set<Marking, MarkingHash> visited;
+    VisitedSet visited(opts);
 
-    Marking start = petri_net.M0; // bắt đầu từ marking đầu
-    q.push(start);
-    visited.insert(start);
+    size_t orbit;
+    bool orbitsKnown = true;
+    size_t expanded = 0;  // Số marking đã lấy khỏi hàng đợi và mở rộng xong
+    BfsCheckpoint checkpoint(opts, checkpointKey(), store.size());
+    bool resumed = opts.resume && checkpoint.resume([&](const Marking &M, bool frontier) {
+        visited.insert(M);
+        if (frontier) q.push(M);
+    }, expanded, result.orbitStates, orbitsKnown);
+    if (!resumed) {
+        Marking start = stored(petri_net.M0, orbit); // bắt đầu từ marking đầu
+        q.push(start);
+        visited.insert(start);
+        orbitsKnown = orbit > 0;
+        result.orbitStates = orbit;
+        checkpoint.start();
+        checkpoint.append(start);
+    }
 
     //cout << "[BFS] Bat dau tu: " << toString(start) << endl;
 
-    while (!q.empty()) {
-        Marking current = q.front(); // lấy marking đầu hàng đợi
+    while (!q.empty() && result.complete) {
+        Marking current = store.expand(q.front()); // lấy marking đầu hàng đợi (dựng lại đủ place)
         q.pop(); // xóa marking khỏi hàng đợi
 
         for (int i = 0; i < (int)petri_net.transitions.size(); i++) { // chạy tất cả transition
             if (isEnabled(petri_net, current, i)) { // kiểm tra transition chạy đc hay ko
-                Marking next = fire(petri_net, current, i) ; // chạy transition để đc marking mới
+                if (overflows(current, i)) {
+                    result.complete = false;
+                    break;
+                }
+                Marking next = stored(fire(petri_net, current, i), orbit); // chạy transition để đc marking mới
 
-                if (visited.find(next) == visited.end()) {
-                    visited.insert(next); // đánh dấu là đã ghé qua
+                VisitedSet::Outcome seen = visited.insert(next); // đánh dấu là đã ghé qua
+                if (seen == VisitedSet::FULL) { // hết bộ nhớ cho phép
+                    LOG_WARN("[REACH] State store full at " << opts.maxStates << " markings (memory limit)");
+                    result.complete = false;
+                    break;
+                }
+                if (seen == VisitedSet::ADDED) {
+                    result.orbitStates += orbit;
+                    orbitsKnown = orbitsKnown && orbit > 0;
                     q.push(next); // xong sau đó đưa vào hàng đợi
+                    checkpoint.append(next);
                 }
             }
         }
+        if (result.complete) checkpoint.boundary(++expanded, result.orbitStates, orbitsKnown);
     }
+    checkpoint.finish(result.complete);
 
 
     result.timeSec = getTimeSec() - t0;
@@ -50,11 +573,13 @@ ReachResult ExplicitReachability::computeBFS() {
     }
     result.memMB = deltaMem;
     result.states = visited.size();
+    if (opts.symmetry.trivial() || !orbitsKnown) result.orbitStates = 0;
+    reportOmissions(visited, opts, result);
 
 
     cout << "[BFS] result: " << result.states
          << " trang thai, " << result.timeSec << " seconds, "
-         << result.memMB << " MB" << endl; 
+         << result.memMB << " MB" << (result.complete ? "" : " (partial)") << endl; 
 
     return result;
 }
@@ -66,24 +591,40 @@ ReachResult ExplicitReachability::computeDFS() {
     double m0 = getMemoryMB();
 
     stack<Marking> s;
-    unordered_set<Marking, MarkingHash> visited;
+    VisitedSet visited(opts);
+    if (!opts.checkpointDir.empty())
+        LOG_WARN("[REACH] Checkpoints need BFS, running DFS without them");
 
-    Marking start = petri_net.M0;
+    size_t orbit;
+    Marking start = stored(petri_net.M0, orbit);
     s.push(start);
     visited.insert(start);
+    bool orbitsKnown = orbit > 0;
+    result.orbitStates = orbit;
 
     cout << "[DFS] Bat dau tu: " << toString(start) << endl;
 
-    while (!s.empty()) {
-        Marking current = s.top(); // lấy marking trên cùng
+    while (!s.empty() && result.complete) {
+        Marking current = store.expand(s.top()); // lấy marking trên cùng
         s.pop();    // xóa marking khỏi ngăn xếp
 
         for(int i = 0; i < (int)petri_net.transitions.size(); i++){
             if (isEnabled(petri_net, current, i)) {
-                Marking next = fire(petri_net, current, i);
+                if (overflows(current, i)) {
+                    result.complete = false;
+                    break;
+                }
+                Marking next = stored(fire(petri_net, current, i), orbit);
 
-                if (visited.find(next) == visited.end()) {
-                    visited.insert(next);   // đánh dấu đã ghé
+                VisitedSet::Outcome seen = visited.insert(next); // đánh dấu là đã ghé qua
+                if (seen == VisitedSet::FULL) { // hết bộ nhớ cho phép
+                    LOG_WARN("[REACH] State store full at " << opts.maxStates << " markings (memory limit)");
+                    result.complete = false;
+                    break;
+                }
+                if (seen == VisitedSet::ADDED) {
+                    result.orbitStates += orbit;
+                    orbitsKnown = orbitsKnown && orbit > 0;
                     s.push(next); // thêm vào ngăn xếp
                 }
             }
@@ -98,17 +639,397 @@ ReachResult ExplicitReachability::computeDFS() {
     }
     result.memMB = deltaMem;
     result.states = visited.size();
+    if (opts.symmetry.trivial() || !orbitsKnown) result.orbitStates = 0;
+    reportOmissions(visited, opts, result);
 
     cout << "[DFS] result: " << result.states
          << " trang thai, " << result.timeSec << " seconds, "
-         << result.memMB << " MB" << endl; 
+         << result.memMB << " MB" << (result.complete ? "" : " (partial)") << endl; 
+
+    return result;
+}
+
+// Disk BFS: trên đĩa chỉ có visited (mọi tầng đã gặp, sắp xếp) và tầng hiện tại.
+// Mỗi tầng: (1) đọc tuần tự tầng d, sinh successor vào các run đã sắp xếp;
+// (2) trộn các run với visited trong một lượt, marking chưa có -> tầng d+1 và visited mới.
+// Petri net là đồ thị có hướng nên phải so với toàn bộ visited, không chỉ hai tầng trước.
+ReachResult ExplicitReachability::computeDiskBFS() {
+    ReachResult result;
+    double t0 = getTimeSec();
+    double m0 = getMemoryMB();
+
+    size_t places = store.size();
+    size_t width = max<size_t>(places, 1);  // Không place nào được lưu: bản ghi 1 byte 0
+    size_t runCapacity = max<size_t>((size_t)(opts.diskBufferMB * 1024 * 1024 / (width + sizeof(uint32_t))), 1);
+    uint64_t key = checkpointKey();
+    string prefix = checkpointPath(opts.diskDir, "bfs", key) + "-";
+    string visitedPath = prefix + "visited", layerPath = prefix + "layer";
+    // Checkpoint ở mỗi ranh giới tầng: visited và tầng hiện tại đã nằm trên đĩa, chỉ cần ghi các con số
+    string statePath = opts.checkpointDir.empty() ? "" : checkpointPath(opts.checkpointDir, "diskbfs", key);
+
+    vector<uint8_t> rec(width, 0);
+    auto pack = [&](const Marking &M) { copy(M.begin(), M.end(), rec.begin()); return rec.data(); };
+    auto unpack = [&](const uint8_t *r) { return store.expand(Marking(r, r + places)); };
+    // Kích thước quỹ đạo của marking chuẩn (0: không biết)
+    auto orbitOf = [&](const uint8_t *r) {
+        size_t orbit = 1;
+        if (!opts.symmetry.trivial()) opts.symmetry.canonical(unpack(r), &orbit);
+        return orbit;
+    };
+
+    size_t orbit;
+    size_t visitedCount = 1, layerCount = 1, layers = 0;
+    bool orbitsKnown = true;
+    vector<double> saved(5);
+    if (opts.resume && !statePath.empty() && filesystem::exists(visitedPath) && filesystem::exists(layerPath)
+        && loadCheckpointState(statePath, "PNDISK", key, saved)) {
+        layers = (size_t)saved[0];
+        visitedCount = (size_t)saved[1];
+        layerCount = (size_t)saved[2];
+        result.orbitStates = (size_t)saved[3];
+        orbitsKnown = saved[4] != 0;
+        LOG_INFO("[REACH] Resumed disk BFS at layer " << layers << ": " << visitedCount << " markings");
+    } else {
+        Marking start = stored(petri_net.M0, orbit);
+        for (const string &path : {visitedPath, layerPath}) {
+            RecordWriter out(path, width);
+            out.write(pack(start));
+            out.close();
+        }
+        orbitsKnown = orbit > 0;
+        result.orbitStates = orbit;
+    }
+    double ioBytes = 2.0 * width;
+
+    while (layerCount && result.complete) {
+        // (1) Mở rộng tầng hiện tại
+        RunSpiller spiller(prefix, width, runCapacity);
+        {
+            RecordReader layer(layerPath, width);
+            while (result.complete && layer.next()) {
+                Marking current = unpack(layer.record());
+                for (int i = 0; i < (int)petri_net.transitions.size(); i++) {
+                    if (!isEnabled(petri_net, current, i)) continue;
+                    if (overflows(current, i)) {
+                        result.complete = false;
+                        break;
+                    }
+                    spiller.add(pack(stored(fire(petri_net, current, i), orbit)));
+                }
+            }
+        }
+        const vector<string> &runs = spiller.finish();
+        if (!result.complete) {
+            for (const string &path : runs) remove(path.c_str());
+            break;
+        }
+
+        // (2) Trộn với visited: duplicate detection trễ, một lượt đọc/ghi tuần tự
+        {
+            RunMerger candidates(runs, width);
+            RecordReader visited(visitedPath, width);
+            RecordWriter nextVisited(visitedPath + ".next", width), nextLayer(layerPath + ".next", width);
+            bool haveOld = visited.next();
+            while (candidates.next()) {
+                const uint8_t *c = candidates.record();
+                int cmp = 1;
+                while (haveOld && (cmp = memcmp(visited.record(), c, width)) < 0) {
+                    nextVisited.write(visited.record());
+                    haveOld = visited.next();
+                }
+                if (haveOld && cmp == 0) continue;  // Đã thăm
+                if (opts.maxStates && visitedCount >= opts.maxStates) { // hết giới hạn
+                    LOG_WARN("[REACH] State store full at " << opts.maxStates << " markings (memory limit)");
+                    result.complete = false;
+                    break;
+                }
+                nextVisited.write(c);
+                nextLayer.write(c);
+                ++visitedCount;
+                size_t o = orbitOf(c);
+                result.orbitStates += o;
+                orbitsKnown = orbitsKnown && o > 0;
+            }
+            for (; haveOld; haveOld = visited.next()) nextVisited.write(visited.record());
+            nextVisited.close();
+            nextLayer.close();
+            if (result.complete) layerCount = nextLayer.records();
+            ioBytes += (double)width * (2 * visitedCount + 2 * layerCount);
+        }
+        for (const string &path : runs) remove(path.c_str());
+        if (!result.complete) {  // Tầng dở dang: giữ visited/tầng cũ, khớp với checkpoint trước
+            remove((visitedPath + ".next").c_str());
+            remove((layerPath + ".next").c_str());
+            break;
+        }
+        remove(visitedPath.c_str());
+        remove(layerPath.c_str());
+        bool renamed = rename((visitedPath + ".next").c_str(), visitedPath.c_str()) == 0;
+        renamed = rename((layerPath + ".next").c_str(), layerPath.c_str()) == 0 && renamed;
+        if (!renamed) {  // File cũ đã bị xóa: checkpoint trước không còn dùng được
+            remove((visitedPath + ".next").c_str());
+            remove((layerPath + ".next").c_str());
+            LOG_WARN("[REACH] Cannot replace BFS files " << visitedPath << ", " << layerPath);
+            result.complete = false;
+            if (!statePath.empty()) {
+                remove(statePath.c_str());
+                statePath.clear();
+            }
+            break;
+        }
+        ++layers;
+        LOG_DEBUG("[REACH] Disk BFS layer " << layers << ": " << layerCount << " new, "
+                  << visitedCount << " visited, " << runs.size() << " runs");
+        if (!statePath.empty())
+            saveCheckpointState(statePath, "PNDISK", key, {(double)layers, (double)visitedCount,
+                                (double)layerCount, (double)result.orbitStates, (double)orbitsKnown});
+    }
+    // Dở dang và có checkpoint: để lại file cho --resume
+    if (result.complete || statePath.empty()) {
+        remove(visitedPath.c_str());
+        remove(layerPath.c_str());
+        if (!statePath.empty()) remove(statePath.c_str());
+    }
+
+    result.timeSec = getTimeSec() - t0;
+    double memNow = getMemoryMB();
+    double deltaMem = memNow - m0;
+    if (deltaMem < 0) {
+        deltaMem = memNow;
+    }
+    result.memMB = deltaMem;
+    result.states = visitedCount;
+    if (opts.symmetry.trivial() || !orbitsKnown) result.orbitStates = 0;
+    LOG_INFO("[REACH] Disk BFS: " << layers << " layers, ~" << ioBytes / (1024 * 1024)
+             << " MB sequential I/O (without runs)");
+
+    cout << "[BFS-DISK] result: " << result.states
+         << " trang thai, " << result.timeSec << " seconds, "
+         << result.memMB << " MB" << (result.complete ? "" : " (partial)") << endl;
+
+    return result;
+}
+
+// ======== SWEEP-LINE ========
+// psi(M) = -Σ h(C_p)·y(p)·M(p): y = tổng các P-invariant (1 cho place không được phủ)
+// nên transition bảo toàn y·M không đổi psi; h(C) >= 1 là thế năng của thành phần liên
+// thông mạnh C chứa p trong đồ thị place (p -> q khi một transition lấy token từ p và
+// đặt vào q), tính từ thành phần cuối (sink) ngược lên. Transition t lấy token từ C:
+// nếu h(C)·(Pre_C - Post_C) > Σ_{q ngoài C} Post(q,t)·y(q)·h(q) (Pre_C, Post_C có trọng
+// số y) thì psi tăng ngặt khi t bắn (input ở thành phần thượng nguồn chỉ làm psi tăng
+// thêm). Phần còn lại là cạnh lùi (regress).
+vector<long long> progressMeasure(const Model &model) {
+    const double H_CAP = 1099511627776.0;  // 2^40: 255 token × vài nghìn place vẫn vừa long long
+    size_t P = model.places.size(), T = model.transitions.size();
+    vector<vector<int>> succ(P);
+    for (size_t t = 0; t < T; ++t)
+        for (size_t p = 0; p < P; ++p)
+            if (model.Pre[p][t] > 0)
+                for (size_t q = 0; q < P; ++q)
+                    if (model.Post[q][t] > 0) succ[p].push_back((int)q);
+
+    // Tarjan (không đệ quy): thành phần được đánh số theo thứ tự topo ngược, sink trước
+    vector<int> comp(P, -1), index(P, -1), low(P, 0), stk;
+    vector<bool> onStack(P, false);
+    vector<pair<int, size_t>> call;  // (place, cạnh kế tiếp)
+    int counter = 0, numComp = 0;
+    for (size_t root = 0; root < P; ++root) {
+        if (index[root] >= 0) continue;
+        call.push_back({(int)root, 0});
+        while (!call.empty()) {
+            int v = call.back().first;
+            size_t &e = call.back().second;
+            if (e == 0 && index[v] < 0) {
+                index[v] = low[v] = counter++;
+                stk.push_back(v);
+                onStack[v] = true;
+            }
+            if (e < succ[v].size()) {
+                int w = succ[v][e++];
+                if (index[w] < 0) call.push_back({w, 0});
+                else if (onStack[w]) low[v] = min(low[v], index[w]);
+                continue;
+            }
+            if (low[v] == index[v]) {
+                int w;
+                do {
+                    w = stk.back();
+                    stk.pop_back();
+                    onStack[w] = false;
+                    comp[w] = numComp;
+                } while (w != v);
+                ++numComp;
+            }
+            call.pop_back();
+            if (!call.empty()) low[call.back().first] = min(low[call.back().first], low[v]);
+        }
+    }
+
+    vector<long long> y(P, 0);
+    for (const auto &inv : computePInvariants(model).invariants)
+        for (const auto &term : inv.terms) y[term.first] += term.second;
+    long long yMax = 1;
+    for (long long &v : y) yMax = max(yMax, v = max(v, 1LL));
+
+    vector<vector<int>> members(numComp);
+    for (size_t p = 0; p < P; ++p) members[comp[p]].push_back((int)p);
+    vector<double> h(numComp, 1);
+    for (int c = 0; c < numComp; ++c) {
+        double need = 1;
+        for (int p : members[c])
+            for (size_t t = 0; t < T; ++t) {
+                if (model.Pre[p][t] == 0) continue;
+                long long preC = 0, postC = 0;
+                double outside = 0;
+                for (size_t q = 0; q < P; ++q) {
+                    if (comp[q] == c) {
+                        preC += y[q] * model.Pre[q][t];
+                        postC += y[q] * model.Post[q][t];
+                    } else {
+                        outside += model.Post[q][t] * y[q] * h[comp[q]];
+                    }
+                }
+                if (preC > postC) need = max(need, floor(outside / (preC - postC)) + 1);
+            }
+        h[c] = min(need, H_CAP / yMax);
+    }
+
+    vector<long long> weights(P);
+    for (size_t p = 0; p < P; ++p) weights[p] = -(long long)h[comp[p]] * y[p];
+    size_t progressing = 0, regressing = 0;
+    for (size_t t = 0; t < T; ++t) {
+        long long delta = 0;
+        for (size_t p = 0; p < P; ++p) delta += weights[p] * (model.Post[p][t] - model.Pre[p][t]);
+        progressing += delta > 0;
+        regressing += delta < 0;
+    }
+    LOG_INFO("[REACH] Progress measure: " << numComp << " place components, " << progressing
+             << " progressing / " << T - progressing - regressing << " stationary / "
+             << regressing << " regressing transitions");
+    return weights;
+}
+
+// Sweep-line tổng quát (Kristensen & Mailund): mở rộng marking theo psi tăng dần; lớp
+// psi nhỏ hơn mọi marking chưa mở rộng không còn gặp lại qua cạnh tiến nên bị xóa.
+// Đích của cạnh lùi (psi giảm) được giữ mãi (persistent) và làm gốc cho lượt quét sau;
+// marking đã xóa có thể được duyệt lại ở lượt sau nên states đếm mỗi lượt một lần,
+// trừ khi sweepDistinct đếm qua bảng fingerprint 64 bit (như --store hashcompact).
+ReachResult ExplicitReachability::computeSweep() {
+    ReachResult result;
+    double t0 = getTimeSec();
+    double m0 = getMemoryMB();
+    if (!opts.checkpointDir.empty())
+        LOG_WARN("[REACH] Checkpoints need BFS, running the sweep-line without them");
+
+    struct Pending {
+        long long progress;
+        Marking M;
+        bool operator<(const Pending &o) const { return progress > o.progress; }  // psi nhỏ ra trước
+    };
+    priority_queue<Pending> unprocessed;
+    map<long long, unordered_set<Marking, MarkingHash>> nodes;  // Theo psi: xóa cả lớp đã quét qua
+    unordered_set<Marking, MarkingHash> persistent;
+    vector<Pending> roots;
+    size_t held = 0, sweeps = 0;
+
+    ReachOptions fingerprints;
+    fingerprints.store = StateStore::HASH_COMPACT;
+    VisitedSet distinct(fingerprints);  // Chỉ dùng khi sweepDistinct
+
+    bool orbitsKnown = true;
+    auto count = [&](const Marking &M, size_t orbit) {
+        orbitsKnown = orbitsKnown && orbit > 0;
+        if (opts.sweepDistinct && distinct.insert(M) != VisitedSet::ADDED) return;
+        ++result.states;
+        result.orbitStates += orbit;
+    };
+
+    size_t orbit;
+    long long psi;
+    Marking start = stored(petri_net.M0, orbit, &psi);
+    persistent.insert(start);
+    roots.push_back({psi, start});
+    count(start, orbit);
+
+    while (!roots.empty() && result.complete) {
+        ++sweeps;
+        for (auto &r : roots) unprocessed.push(move(r));
+        roots.clear();
+
+        while (!unprocessed.empty() && result.complete) {
+            long long level = unprocessed.top().progress;
+            Marking current = store.expand(unprocessed.top().M);
+            unprocessed.pop();
+
+            for (int i = 0; i < (int)petri_net.transitions.size(); i++) {
+                if (!isEnabled(petri_net, current, i)) continue;
+                if (overflows(current, i)) {
+                    result.complete = false;
+                    break;
+                }
+                Marking next = stored(fire(petri_net, current, i), orbit, &psi);
+                if (persistent.count(next)) continue;
+                bool regress = psi < level;
+                if (!regress) {
+                    auto layer = nodes.find(psi);
+                    if (layer != nodes.end() && layer->second.count(next)) continue;
+                }
+                if (opts.maxStates && held + persistent.size() >= opts.maxStates) { // hết bộ nhớ cho phép
+                    LOG_WARN("[REACH] State store full at " << opts.maxStates << " markings (memory limit)");
+                    result.complete = false;
+                    break;
+                }
+                if (regress) {
+                    persistent.insert(next);
+                    roots.push_back({psi, next});
+                } else {
+                    nodes[psi].insert(next);
+                    ++held;
+                    unprocessed.push({psi, next});
+                }
+                count(next, orbit);
+            }
+            result.peakStored = max(result.peakStored, held + persistent.size());
+
+            // Cạnh tiến không đi xuống dưới marking chưa mở rộng nhỏ nhất
+            long long frontier = unprocessed.empty() ? LLONG_MAX : unprocessed.top().progress;
+            while (!nodes.empty() && nodes.begin()->first < frontier) {
+                held -= nodes.begin()->second.size();
+                nodes.erase(nodes.begin());
+            }
+        }
+    }
+
+    result.timeSec = getTimeSec() - t0;
+    double memNow = getMemoryMB();
+    double deltaMem = memNow - m0;
+    if (deltaMem < 0) {
+        deltaMem = memNow;
+    }
+    result.memMB = deltaMem;
+    if (opts.symmetry.trivial() || !orbitsKnown) result.orbitStates = 0;
+    LOG_INFO("[REACH] Sweep-line: " << sweeps << " sweeps, " << persistent.size()
+             << " persistent markings, peak " << result.peakStored << " stored");
+    result.sweeps = sweeps;
+    if (opts.sweepDistinct) reportOmissions(distinct, fingerprints, result);
+    else if (sweeps > 1)
+        LOG_WARN("[REACH] " << sweeps << " sweeps: a marking revisited by a later sweep is counted again"
+                 " (States is an upper bound; --sweep-distinct counts each once)");
+
+    cout << "[SWEEP] result: " << result.states
+         << " trang thai, " << result.timeSec << " seconds, "
+         << result.memMB << " MB" << (result.complete ? "" : " (partial)") << endl;
 
     return result;
 }
 
 ReachResult explicitReach(const Model &model, const ReachOptions &opts) {
-    ExplicitReachability analyzer(model);
-    if (opts.useBFS) {
+    ExplicitReachability analyzer(model, opts);
+    if (opts.sweep) {
+        return analyzer.computeSweep();
+    } else if (!opts.diskDir.empty()) {
+        return analyzer.computeDiskBFS();
+    } else if (opts.useBFS) {
         return analyzer.computeBFS();
     } else {
         return analyzer.computeDFS();
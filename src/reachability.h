@@ -7,21 +7,70 @@
  */
 
 #include "utils.h"
+#include "invariants.h"
+#include "symmetry.h"
+
+// Visited-marking store. HASH_COMPACT keeps a bitsPerState-bit fingerprint per
+// marking, BITSTATE sets hashFunctions bits in a Bloom filter: both may report a
+// new marking as visited (hash collision) and so miss part of the state space
+enum class StateStore { EXACT, HASH_COMPACT, BITSTATE };
 
 struct ReachOptions {
     bool useBFS = true;  // true = BFS, false = DFS
+    size_t maxStates = 0;  // >0: stop (partial result) once this many markings are stored;
+                           // BITSTATE: expected markings, sizes the filter (0 = 2^24)
+    StateStore store = StateStore::EXACT;
+    int bitsPerState = 0;   // HASH_COMPACT: fingerprint width (0 = 64); BITSTATE: filter bits per marking (0 = 16)
+    int hashFunctions = 3;  // BITSTATE: bits set per marking
+    string diskDir;            // Non-empty: BFS with the visited set and layers on disk (store ignored)
+    double diskBufferMB = 256; // Disk BFS: successors sorted in memory before spilling a run
+    string checkpointDir;       // Non-empty: BFS progress is saved here (DFS runs without)
+    double checkpointSec = 300; // Seconds between checkpoints; a partial result always saves one
+    bool resume = false;        // Continue from the checkpoint in checkpointDir if it matches
+    vector<Invariant> invariants;  // P-invariants: only the places they leave free are stored
+    Symmetry symmetry;             // Non-trivial: one marking per orbit (canonical form) is stored
+    bool sweep = false;            // Sweep-line: forget markings the progress order has passed
+    vector<long long> progress;    // Sweep-line: psi(M) = sum progress[p] * M[p] (empty: progressMeasure)
+    bool sweepDistinct = false;    // Sweep-line: count each marking once over all sweeps (64-bit fingerprint per marking)
 };
 
 class ExplicitReachability {
 public:
-    ExplicitReachability(const Model &model);
+    ExplicitReachability(const Model &model, const ReachOptions &opts = ReachOptions());
     ReachResult computeBFS();  // Breadth-first search
     ReachResult computeDFS();  // Depth-first search
+    // BFS with delayed duplicate detection: layer d+1 = successors of layer d,
+    // sorted in runs, merged and subtracted from the sorted visited file in one pass
+    ReachResult computeDiskBFS();
+    // Generalized sweep-line: markings are expanded by increasing progress and
+    // forgotten once every unexpanded one has larger progress; targets of
+    // regress edges are kept and start another sweep
+    ReachResult computeSweep();
 private:
+    bool overflows(const Marking &M, int t) const;  // Firing t pushes a place past MAX_TOKENS
+    // Canonical form, then compressed; progress gets psi of the canonical form
+    Marking stored(Marking M, size_t &orbit, long long *progress = nullptr) const;
+    uint64_t checkpointKey() const;  // Model + everything that shapes stored(M) and the store
+
     const Model &petri_net;
+    ReachOptions opts;
+    PlaceBasis store;  // visited and the frontier hold stored(M)
+    vector<long long> progressWeights;  // Sweep-line measure (empty unless opts.sweep)
+    vector<vector<pair<int, int>>> growth;  // Per transition: (place, Post - Pre > 0)
 };
 
 // Main entry point
 ReachResult explicitReach(const Model &model, const ReachOptions &opts);
 
+// Linear progress measure derived from the net: strictly increasing on
+// transitions between strongly connected parts of the place graph, constant
+// on conservative transitions inside one
+vector<long long> progressMeasure(const Model &model);
+
+// Number of markings that fit in memLimitMB (visited set + frontier), 0 = no limit;
+// storedPlaces: bytes kept per marking (0 = every place). BITSTATE: the filter
+// takes the whole budget and the result is its expected marking count
+size_t explicitStateCap(const Model &model, double memLimitMB, size_t storedPlaces = 0,
+                        StateStore store = StateStore::EXACT, int bitsPerState = 0);
+
 #endif
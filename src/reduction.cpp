@@ -0,0 +1,299 @@
+/*
+ * reduction.cpp - Structural net reductions
+ *
+ * The rules run on a full-size copy of the net with alive flags and are
+ * repeated until none applies; the survivors are then compacted into a new
+ * Model. Every rule keeps the deadlocks and the reachable markings of the
+ * kept places:
+ *  - dead pruning: a transition whose preset can never be marked (fixpoint
+ *    from M0) never fires; places that never get a token only fed those;
+ *  - constant places: a place only in self-loops keeps M0[p]; transitions
+ *    needing more are dead, the others never wait for it;
+ *  - self-loop transitions: firing one changes nothing, and when another
+ *    transition needs no more tokens it is never the only enabled one;
+ *  - duplicate places: p with exactly the same arcs as q holds
+ *    M(q) + M0(p) - M0(q) forever, so with M0(p) >= M0(q) it never disables
+ *    anything q doesn't (implicit places in general are not looked for);
+ *  - series places (p -t-> q, t the only consumer of p, weight 1 arcs):
+ *    a token in p can always move on, so producers of p feed q directly;
+ *  - series transitions (t1 -p-> t2, p private to them, weight 1 arcs):
+ *    t2 can always fire after t1, so t1;t2 becomes one transition.
+ * In both fusions a marking with a token inside the chain enables its
+ * next step, hence is no deadlock, and firing that step early only adds
+ * tokens, so the other reachable markings are unchanged.
+ */
+
+#include "reduction.h"
+#include "logger.h"
+
+using namespace std;
+
+namespace {
+
+class Reducer {
+public:
+    Reducer(const Model &model, const ReduceOptions &opts)
+        : net(model), opts(opts), P(model.places.size()), T(model.transitions.size()),
+          placeAlive(P, true), transAlive(T, true), kept(P, false), names(model.transitions) {
+        for (int p : opts.keepPlaces)
+            if (p >= 0 && p < (int)P) kept[p] = true;
+    }
+
+    Reduction run() {
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            if (opts.pruneDead) changed |= pruneDead();
+            if (opts.removeConstant) changed |= removeConstant();
+            if (opts.removeSelfLoops) changed |= removeSelfLoops();
+            if (opts.removeDuplicatePlaces) changed |= removeDuplicatePlaces();
+            if (opts.fuseSeriesPlaces) changed |= fuseSeriesPlaces();
+            if (opts.fuseSeriesTransitions) changed |= fuseSeriesTransitions();
+        }
+        return compact();
+    }
+
+private:
+    Model net;  // Working copy: rules edit Post and M0 in place
+    const ReduceOptions &opts;
+    size_t P, T;
+    vector<bool> placeAlive, transAlive, kept;
+    vector<string> names;
+    vector<RemovedPlace> removed;
+
+    void removePlace(int p, int source, int offset) {
+        placeAlive[p] = false;
+        removed.push_back({p, source, offset});
+    }
+
+    // The only alive place with a nonzero entry in column t of W (-1: none or several)
+    int single(const vector<vector<int>> &W, int t) const {
+        int found = -1;
+        for (size_t p = 0; p < P; ++p) {
+            if (!placeAlive[p] || W[p][t] == 0) continue;
+            if (found >= 0) return -1;
+            found = (int)p;
+        }
+        return found;
+    }
+
+    // The only alive transition with a nonzero entry in row p of W (-1: none or several)
+    int single(const vector<int> &row) const {
+        int found = -1;
+        for (size_t t = 0; t < T; ++t) {
+            if (!transAlive[t] || row[t] == 0) continue;
+            if (found >= 0) return -1;
+            found = (int)t;
+        }
+        return found;
+    }
+
+    bool pruneDead() {
+        vector<bool> marked(P, false), fires(T, false);
+        for (size_t p = 0; p < P; ++p) marked[p] = placeAlive[p] && net.M0[p] > 0;
+        bool grew = true;
+        while (grew) {
+            grew = false;
+            for (size_t t = 0; t < T; ++t) {
+                if (!transAlive[t] || fires[t]) continue;
+                bool ok = true;
+                for (size_t p = 0; p < P && ok; ++p)
+                    if (placeAlive[p] && net.Pre[p][t] > 0 && !marked[p]) ok = false;
+                if (!ok) continue;
+                fires[t] = grew = true;
+                for (size_t p = 0; p < P; ++p)
+                    if (placeAlive[p] && net.Post[p][t] > 0) marked[p] = true;
+            }
+        }
+
+        bool changed = false;
+        for (size_t t = 0; t < T; ++t) {
+            if (transAlive[t] && !fires[t]) {
+                transAlive[t] = false;
+                changed = true;
+            }
+        }
+        for (size_t p = 0; p < P; ++p) {
+            if (placeAlive[p] && !marked[p] && !kept[p]) {
+                removePlace((int)p, -1, 0);
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    bool removeConstant() {
+        bool changed = false;
+        for (size_t p = 0; p < P; ++p) {
+            if (!placeAlive[p] || kept[p]) continue;
+            bool constant = true;
+            for (size_t t = 0; t < T && constant; ++t)
+                if (transAlive[t] && net.Pre[p][t] != net.Post[p][t]) constant = false;
+            if (!constant) continue;
+
+            for (size_t t = 0; t < T; ++t)
+                if (transAlive[t] && net.Pre[p][t] > net.M0[p]) transAlive[t] = false;
+            removePlace((int)p, -1, net.M0[p]);
+            changed = true;
+        }
+        return changed;
+    }
+
+    bool removeSelfLoops() {
+        bool changed = false;
+        for (size_t t = 0; t < T; ++t) {
+            if (!transAlive[t]) continue;
+            bool loop = true;
+            for (size_t p = 0; p < P && loop; ++p)
+                if (placeAlive[p] && net.Pre[p][t] != net.Post[p][t]) loop = false;
+            if (!loop) continue;
+
+            for (size_t u = 0; u < T; ++u) {
+                if (u == t || !transAlive[u]) continue;
+                bool needsLess = true;
+                for (size_t p = 0; p < P && needsLess; ++p)
+                    if (placeAlive[p] && net.Pre[p][u] > net.Pre[p][t]) needsLess = false;
+                if (needsLess) {
+                    transAlive[t] = false;
+                    changed = true;
+                    break;
+                }
+            }
+        }
+        return changed;
+    }
+
+    bool removeDuplicatePlaces() {
+        // Group places by their arcs to alive transitions
+        unordered_map<uint64_t, vector<int>> byArcs;
+        for (size_t p = 0; p < P; ++p) {
+            if (!placeAlive[p]) continue;
+            uint64_t h = FNV_OFFSET;
+            for (size_t t = 0; t < T; ++t) {
+                if (!transAlive[t]) continue;
+                int arcs[2] = {net.Pre[p][t], net.Post[p][t]};
+                h = fnv1a(arcs, sizeof(arcs), h);
+            }
+            byArcs[h].push_back((int)p);
+        }
+
+        bool changed = false;
+        for (auto &group : byArcs) {
+            const vector<int> &ps = group.second;
+            for (int p : ps) {
+                if (kept[p]) continue;
+                for (int q : ps) {
+                    if (q == p || !placeAlive[q] || net.M0[p] < net.M0[q] || !sameArcs(p, q)) continue;
+                    removePlace(p, q, net.M0[p] - net.M0[q]);
+                    changed = true;
+                    break;
+                }
+            }
+        }
+        return changed;
+    }
+
+    bool sameArcs(int p, int q) const {
+        for (size_t t = 0; t < T; ++t)
+            if (transAlive[t] && (net.Pre[p][t] != net.Pre[q][t] || net.Post[p][t] != net.Post[q][t]))
+                return false;
+        return true;
+    }
+
+    bool fuseSeriesPlaces() {
+        bool changed = false;
+        for (size_t t = 0; t < T; ++t) {
+            if (!transAlive[t]) continue;
+            int p = single(net.Pre, (int)t);
+            int q = single(net.Post, (int)t);
+            if (p < 0 || q < 0 || p == q || kept[p] || kept[q]) continue;
+            if (net.Pre[p][t] != 1 || net.Post[q][t] != 1 || net.M0[p] != 0) continue;
+            if (single(net.Pre[p]) != (int)t) continue;  // t must be p's only consumer
+
+            for (size_t u = 0; u < T; ++u) {
+                if (!transAlive[u] || net.Post[p][u] == 0) continue;
+                net.Post[q][u] += net.Post[p][u];
+                net.Post[p][u] = 0;
+            }
+            transAlive[t] = false;
+            removePlace(p, -1, 0);
+            changed = true;
+        }
+        return changed;
+    }
+
+    bool fuseSeriesTransitions() {
+        bool changed = false;
+        for (size_t p = 0; p < P; ++p) {
+            if (!placeAlive[p] || kept[p] || net.M0[p] != 0) continue;
+            int t1 = single(net.Post[p]);
+            int t2 = single(net.Pre[p]);
+            if (t1 < 0 || t2 < 0 || t1 == t2) continue;
+            if (net.Post[p][t1] != 1 || net.Pre[p][t2] != 1) continue;
+            if (single(net.Post, t1) != (int)p || single(net.Pre, t2) != (int)p) continue;
+
+            bool touchesKept = false;
+            for (size_t r = 0; r < P; ++r)
+                if (placeAlive[r] && kept[r] && net.Post[r][t2] > 0) touchesKept = true;
+            if (touchesKept) continue;
+
+            for (size_t r = 0; r < P; ++r) net.Post[r][t1] = net.Post[r][t2];
+            names[t1] += "+" + names[t2];
+            transAlive[t2] = false;
+            removePlace((int)p, -1, 0);
+            changed = true;
+        }
+        return changed;
+    }
+
+    Reduction compact() const {
+        Reduction red;
+        red.originalPlaces = P;
+        red.removed = removed;
+        Model &m = red.reduced;
+        for (size_t p = 0; p < P; ++p) {
+            if (!placeAlive[p]) continue;
+            m.placeIndex[net.places[p]] = (int)m.places.size();
+            m.places.push_back(net.places[p]);
+            m.M0.push_back(net.M0[p]);
+            red.placeOrigin.push_back((int)p);
+        }
+        for (size_t t = 0; t < T; ++t) {
+            if (!transAlive[t]) continue;
+            m.transIndex[names[t]] = (int)m.transitions.size();
+            m.transitions.push_back(names[t]);
+            red.transitionOrigin.push_back((int)t);
+        }
+        m.Pre.assign(m.places.size(), vector<int>(m.transitions.size(), 0));
+        m.Post.assign(m.places.size(), vector<int>(m.transitions.size(), 0));
+        for (size_t i = 0; i < m.places.size(); ++i) {
+            for (size_t j = 0; j < m.transitions.size(); ++j) {
+                m.Pre[i][j] = net.Pre[red.placeOrigin[i]][red.transitionOrigin[j]];
+                m.Post[i][j] = net.Post[red.placeOrigin[i]][red.transitionOrigin[j]];
+                m.arcCount += (m.Pre[i][j] > 0) + (m.Post[i][j] > 0);
+            }
+        }
+        return red;
+    }
+};
+
+} // namespace
+
+Reduction reduceModel(const Model &model, const ReduceOptions &opts) {
+    Reduction red = Reducer(model, opts).run();
+    LOG_INFO("[REDUCE] Places " << model.places.size() << " -> " << red.reduced.places.size()
+             << ", transitions " << model.transitions.size() << " -> "
+             << red.reduced.transitions.size());
+    return red;
+}
+
+Marking Reduction::expand(const Marking &M) const {
+    vector<int> full(originalPlaces, 0);
+    for (size_t i = 0; i < placeOrigin.size() && i < M.size(); ++i) full[placeOrigin[i]] = M[i];
+    for (auto it = removed.rbegin(); it != removed.rend(); ++it)
+        full[it->place] = (it->source >= 0 ? full[it->source] : 0) + it->offset;
+
+    Marking out(originalPlaces);
+    for (size_t p = 0; p < originalPlaces; ++p) out[p] = (Token)min(max(full[p], 0), MAX_TOKENS);
+    return out;
+}
@@ -0,0 +1,45 @@
+#ifndef REDUCTION_H
+#define REDUCTION_H
+
+/*
+ * reduction.h - Structural net reductions (preprocessing before BFS/BDD/ILP)
+ * Rewrites the Model with rules that keep its deadlocks and the reachable
+ * markings of designated places, and records how to map markings back
+ */
+
+#include "utils.h"
+
+struct ReduceOptions {
+    vector<int> keepPlaces;         // Never removed or merged; their reachable markings are preserved
+    bool pruneDead = true;          // Transitions that can never fire, places that never get a token
+    bool removeConstant = true;     // Places only in self-loops (constant marking)
+    bool removeSelfLoops = true;    // Self-loop transitions whose preset covers another transition's
+    bool removeDuplicatePlaces = true;  // Places with exactly the same arcs as another (M(p) = M(q) + c);
+                                        // other implicit places are not detected
+    bool fuseSeriesPlaces = true;   // p -t-> q, t the only consumer of p: merge p into q, drop t
+    bool fuseSeriesTransitions = true;  // t1 -p-> t2 through a private place p: fuse t1;t2
+};
+
+// A removed place is rebuilt from the reduced marking as M[source] + offset
+// (source = -1: just offset). Exact for markings where no token is in
+// transit through a fused place, which includes every deadlock.
+struct RemovedPlace {
+    int place;   // Original index
+    int source;  // Original index, or -1
+    int offset;
+};
+
+struct Reduction {
+    Model reduced;
+    vector<int> placeOrigin;       // Reduced place -> original place
+    vector<int> transitionOrigin;  // Reduced transition -> original (first of a fused chain)
+    vector<RemovedPlace> removed;  // In the order the rules removed them
+    size_t originalPlaces = 0;
+
+    // Original marking for a marking of the reduced net (e.g. a deadlock witness)
+    Marking expand(const Marking& M) const;
+};
+
+Reduction reduceModel(const Model& model, const ReduceOptions& opts);
+
+#endif
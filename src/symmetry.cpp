@@ -0,0 +1,304 @@
+/*
+ * symmetry.cpp - Net automorphisms by individualization/refinement
+ *
+ * The net is a coloured graph: places and transitions are vertices, arcs
+ * carry their direction and weight, places start coloured by M0. Colours
+ * are refined until equitable (a vertex's colour fixes the multiset of
+ * (arc, neighbour colour)); colour ids are ranks of sorted signatures, so
+ * they only depend on the structure and isomorphic branches of the search
+ * get the same colours.
+ * The first path individualizes the first vertex of the first non-trivial
+ * cell until the partition is discrete; its base points b_0, b_1, ... give
+ * a stabilizer chain. Going up from the deepest level, every w in b_i's
+ * cell that is not yet in the orbit of b_i is tried: a leaf under w whose
+ * colour -> vertex map, composed with the first leaf's, is an automorphism
+ * yields a new generator. |G| is the product of the orbit sizes.
+ */
+
+#include "symmetry.h"
+#include "logger.h"
+#include <map>
+
+using namespace std;
+
+namespace {
+
+using Perm = vector<int>;
+
+class AutomorphismSearch {
+public:
+    AutomorphismSearch(const Model &model, const SymmetryOptions &opts)
+        : net(model), opts(opts), P(model.places.size()), T(model.transitions.size()), n(P + T), adj(n) {
+        // Labels: 4 * weight + (0: p -> t as seen from p, 1: from t, 2: t -> p from t, 3: from p)
+        for (int p = 0; p < P; ++p) {
+            for (int t = 0; t < T; ++t) {
+                if (net.Pre[p][t] > 0) {
+                    adj[p].push_back({P + t, 4 * net.Pre[p][t]});
+                    adj[P + t].push_back({p, 4 * net.Pre[p][t] + 1});
+                }
+                if (net.Post[p][t] > 0) {
+                    adj[P + t].push_back({p, 4 * net.Post[p][t] + 2});
+                    adj[p].push_back({P + t, 4 * net.Post[p][t] + 3});
+                }
+            }
+        }
+    }
+
+    Symmetry run() {
+        vector<long long> key(n);
+        for (int v = 0; v < n; ++v) key[v] = v < P ? net.M0[v] : MAX_TOKENS + 1;
+        vector<int> color = rerank(key);
+        refine(color);
+
+        // First path down to a discrete partition
+        leftColors.push_back(color);
+        while (true) {
+            int c = targetCell(color);
+            if (c < 0) break;
+            int b = cellOf(color, c).front();
+            leftBase.push_back(b);
+            color = individualize(color, b);
+            leftColors.push_back(color);
+        }
+        leftLeaf.assign(n, 0);
+        for (int v = 0; v < n; ++v) leftLeaf[color[v]] = v;
+        for (const auto &c : leftColors) leftSizes.push_back(cellSizes(c));
+
+        const int depth = (int)leftBase.size();
+        vector<vector<Perm>> transversals(depth);
+        for (int i = depth - 1; i >= 0 && !exhausted; --i) {
+            map<int, Perm> orbit = orbitOf(leftBase[i], i);
+            for (int w : cellOf(leftColors[i], targetCell(leftColors[i]))) {
+                if (orbit.count(w)) continue;
+                vector<int> next = individualize(leftColors[i], w);
+                Perm perm(n);
+                if (cellSizes(next) == leftSizes[i + 1] && search(next, i + 1, perm)) {
+                    gens.push_back(perm);
+                    genLevel.push_back(i);
+                    orbit = orbitOf(leftBase[i], i);
+                }
+                if (exhausted) break;
+            }
+            for (const auto &entry : orbit) transversals[i].push_back(placePart(entry.second));
+        }
+
+        if (exhausted)
+            LOG_WARN("[SYMMETRY] Search budget of " << opts.maxSearchNodes
+                     << " refinements used up, keeping the automorphisms found so far");
+        vector<Perm> placeGens;
+        for (const Perm &g : gens) placeGens.push_back(placePart(g));
+        return Symmetry(P, placeGens, transversals, !exhausted, opts);
+    }
+
+private:
+    const Model &net;
+    const SymmetryOptions &opts;
+    int P, T, n;
+    vector<vector<pair<int, int>>> adj;  // (neighbour, label)
+    size_t nodes = 0;
+    bool exhausted = false;
+
+    vector<vector<int>> leftColors;  // Partition at each depth of the first path
+    vector<vector<int>> leftSizes;   // Cell sizes by colour, same depths
+    vector<int> leftBase;            // Base points b_i
+    vector<int> leftLeaf;            // First leaf: colour -> vertex
+    vector<Perm> gens;               // Generators on all vertices
+    vector<int> genLevel;            // Generator i fixes b_0 .. b_{genLevel[i]-1}
+
+    // Colours = ranks of the distinct keys
+    static vector<int> rerank(const vector<long long> &key) {
+        vector<long long> sorted(key);
+        sort(sorted.begin(), sorted.end());
+        sorted.erase(unique(sorted.begin(), sorted.end()), sorted.end());
+        vector<int> color(key.size());
+        for (size_t v = 0; v < key.size(); ++v)
+            color[v] = (int)(lower_bound(sorted.begin(), sorted.end(), key[v]) - sorted.begin());
+        return color;
+    }
+
+    void refine(vector<int> &color) {
+        int cells = *max_element(color.begin(), color.end()) + 1;
+        vector<vector<long long>> sig(n);
+        while (true) {
+            for (int v = 0; v < n; ++v) {
+                sig[v].clear();
+                for (const auto &e : adj[v]) sig[v].push_back((long long)e.second * n + color[e.first]);
+                sort(sig[v].begin(), sig[v].end());
+                sig[v].insert(sig[v].begin(), color[v]);
+            }
+            vector<int> order(n);
+            for (int v = 0; v < n; ++v) order[v] = v;
+            sort(order.begin(), order.end(), [&](int a, int b) { return sig[a] < sig[b]; });
+            int rank = -1;
+            for (int i = 0; i < n; ++i) {
+                if (i == 0 || sig[order[i]] != sig[order[i - 1]]) ++rank;
+                color[order[i]] = rank;
+            }
+            if (rank + 1 == cells) return;
+            cells = rank + 1;
+        }
+    }
+
+    vector<int> individualize(const vector<int> &color, int v) {
+        ++nodes;
+        vector<long long> key(n);
+        for (int u = 0; u < n; ++u) key[u] = 2LL * color[u] + (u != v);
+        vector<int> out = rerank(key);
+        refine(out);
+        return out;
+    }
+
+    vector<int> cellSizes(const vector<int> &color) const {
+        vector<int> sizes(n, 0);
+        for (int c : color) sizes[c]++;
+        return sizes;
+    }
+
+    // First colour with more than one vertex, -1 when discrete
+    int targetCell(const vector<int> &color) const {
+        vector<int> sizes = cellSizes(color);
+        for (int c = 0; c < n; ++c)
+            if (sizes[c] > 1) return c;
+        return -1;
+    }
+
+    vector<int> cellOf(const vector<int> &color, int c) const {
+        vector<int> cell;
+        for (int v = 0; v < n; ++v)
+            if (color[v] == c) cell.push_back(v);
+        return cell;
+    }
+
+    // Leaves below color (at depth of the first path) whose map is an automorphism
+    bool search(const vector<int> &color, int depth, Perm &perm) {
+        if (nodes > opts.maxSearchNodes) {
+            exhausted = true;
+            return false;
+        }
+        int c = targetCell(color);
+        if (c < 0) {
+            for (int v = 0; v < n; ++v) perm[leftLeaf[color[v]]] = v;
+            return isAutomorphism(perm);
+        }
+        if (depth + 1 >= (int)leftSizes.size()) return false;
+        for (int x : cellOf(color, c)) {
+            vector<int> next = individualize(color, x);
+            if (cellSizes(next) == leftSizes[depth + 1] && search(next, depth + 1, perm)) return true;
+            if (exhausted) return false;
+        }
+        return false;
+    }
+
+    bool isAutomorphism(const Perm &perm) const {
+        for (int p = 0; p < P; ++p) {
+            int q = perm[p];
+            if (q >= P || net.M0[p] != net.M0[q]) return false;
+            for (int t = 0; t < T; ++t) {
+                int u = perm[P + t] - P;
+                if (u < 0 || net.Pre[p][t] != net.Pre[q][u] || net.Post[p][t] != net.Post[q][u]) return false;
+            }
+        }
+        return true;
+    }
+
+    // Orbit of b under the generators fixing b_0 .. b_{level-1}, with an element reaching each point
+    map<int, Perm> orbitOf(int b, int level) const {
+        Perm id(n);
+        for (int v = 0; v < n; ++v) id[v] = v;
+        map<int, Perm> orbit{{b, id}};
+        vector<int> queue{b};
+        for (size_t head = 0; head < queue.size(); ++head) {
+            const Perm &e = orbit[queue[head]];
+            for (size_t g = 0; g < gens.size(); ++g) {
+                if (genLevel[g] < level) continue;
+                int y = gens[g][queue[head]];
+                if (orbit.count(y)) continue;
+                Perm composed(n);
+                for (int v = 0; v < n; ++v) composed[v] = gens[g][e[v]];
+                orbit.emplace(y, move(composed));
+                queue.push_back(y);
+            }
+        }
+        return orbit;
+    }
+
+    Perm placePart(const Perm &g) const { return Perm(g.begin(), g.begin() + P); }
+};
+
+// (M^g)[g(p)] = M[p]
+void applyPerm(const Marking &M, const vector<int> &g, Marking &out) {
+    for (size_t p = 0; p < M.size(); ++p) out[g[p]] = M[p];
+}
+
+} // namespace
+
+Symmetry::Symmetry(size_t numPlaces, vector<vector<int>> placeGenerators,
+                   const vector<vector<vector<int>>> &transversals, bool complete, const SymmetryOptions &opts)
+    : numPlaces(numPlaces), gens(move(placeGenerators)) {
+    groupOrder = 1;
+    for (const auto &level : transversals) groupOrder *= (double)level.size();
+    if (!complete) groupOrder = 0;
+
+    if (complete && groupOrder <= (double)opts.maxElements) {
+        // G_i = T_i G_{i+1}: (t h)(p) = t[h[p]]
+        vector<int> id(numPlaces);
+        for (size_t p = 0; p < numPlaces; ++p) id[p] = (int)p;
+        elements = {id};
+        for (auto level = transversals.rbegin(); level != transversals.rend(); ++level) {
+            vector<vector<int>> next;
+            for (const auto &t : *level) {
+                for (const auto &h : elements) {
+                    vector<int> th(numPlaces);
+                    for (size_t p = 0; p < numPlaces; ++p) th[p] = t[h[p]];
+                    next.push_back(move(th));
+                }
+            }
+            elements = move(next);
+        }
+        return;
+    }
+    for (const auto &level : transversals)
+        for (const auto &t : level)
+            if (!is_sorted(t.begin(), t.end())) descent.push_back(t);  // Skip the identity
+    for (const auto &g : gens) descent.push_back(g);
+}
+
+Marking Symmetry::canonical(const Marking &M, size_t *orbitSize) const {
+    if (gens.empty()) {
+        if (orbitSize) *orbitSize = 1;
+        return M;
+    }
+    Marking best = M, img(M.size());
+    if (!elements.empty()) {
+        size_t stabilizer = 0;
+        for (const auto &g : elements) {
+            applyPerm(M, g, img);
+            if (img == M) ++stabilizer;
+            else if (img < best) best = img;
+        }
+        if (orbitSize) *orbitSize = elements.size() / stabilizer;
+        return best;
+    }
+    bool improved = true;
+    while (improved) {
+        improved = false;
+        for (const auto &g : descent) {
+            applyPerm(best, g, img);
+            if (img < best) {
+                best.swap(img);
+                improved = true;
+            }
+        }
+    }
+    if (orbitSize) *orbitSize = 0;
+    return best;
+}
+
+Symmetry findSymmetries(const Model &model, const SymmetryOptions &opts) {
+    double t0 = getTimeSec();
+    Symmetry sym = AutomorphismSearch(model, opts).run();
+    LOG_INFO("[SYMMETRY] " << sym.generators() << " generators, |G| = " << sym.order()
+             << (sym.exact() ? "" : " (canonical form by descent)") << " ("
+             << getTimeSec() - t0 << "s)");
+    return sym;
+}
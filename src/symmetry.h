@@ -0,0 +1,48 @@
+#ifndef SYMMETRY_H
+#define SYMMETRY_H
+
+/*
+ * symmetry.h - Automorphisms of the net (place/transition permutations that
+ * keep Pre, Post and M0) and canonical markings for symmetry reduction:
+ * the explicit engine stores one marking per orbit
+ */
+
+#include "utils.h"
+
+struct SymmetryOptions {
+    size_t maxSearchNodes = 100000;  // Refinement steps for the automorphism search (then: a subgroup)
+    size_t maxElements = 1000;       // Groups up to this order are enumerated: exact canonical form
+};
+
+class Symmetry {
+public:
+    Symmetry() = default;  // Trivial group
+    // transversals[i]: place parts of the coset representatives of level i of
+    // the stabilizer chain; complete = false when the search ran out of budget
+    Symmetry(size_t numPlaces, vector<vector<int>> placeGenerators,
+             const vector<vector<vector<int>>>& transversals, bool complete, const SymmetryOptions& opts);
+
+    double order() const { return groupOrder; }       // |G|, 0 when the search was cut short
+    size_t generators() const { return gens.size(); }
+    bool trivial() const { return gens.empty(); }
+    bool exact() const { return !elements.empty(); }   // canonical() picks one marking per orbit
+
+    // Lexicographically smallest image of M. Exact: over the whole group, and
+    // orbitSize gets |orbit of M|; otherwise a local minimum under the
+    // transversal elements (sound, may keep several markings of an orbit)
+    // and orbitSize gets 0.
+    Marking canonical(const Marking& M, size_t* orbitSize = nullptr) const;
+
+    const vector<vector<int>>& placeGenerators() const { return gens; }
+
+private:
+    size_t numPlaces = 0;
+    double groupOrder = 1;
+    vector<vector<int>> gens;      // Place parts of the generators: p -> image
+    vector<vector<int>> elements;  // Every element (exact mode)
+    vector<vector<int>> descent;   // Transversal elements (descent mode)
+};
+
+Symmetry findSymmetries(const Model& model, const SymmetryOptions& opts = SymmetryOptions());
+
+#endif
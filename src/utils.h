@@ -22,9 +22,10 @@
 
 using namespace std;
 
-// Basic types for 1-safe Petri nets
-using Token = uint8_t;      // 0 or 1 token per place
+// Basic types for k-bounded Petri nets (1-safe is k = 1)
+using Token = uint8_t;      // 0..MAX_TOKENS tokens per place
 using Marking = vector<Token>;
+const int MAX_TOKENS = 255;
 
 // Petri Net model structure
 struct Model {
@@ -44,6 +45,31 @@ struct ReachResult {
     size_t states = 0;
     double timeSec = 0.0;
     double memMB = 0.0;
+    bool complete = true;   // false: state-store cap hit, states = markings found so far
+    size_t orbitStates = 0; // Symmetry reduction: markings the stored ones stand for (0: unknown)
+    double omissionProb = 0.0;  // Hash-compaction/bitstate store (or sweep-line distinct count): estimated P(some marking was missed)
+    size_t peakStored = 0;  // Sweep-line: most markings held at once
+    size_t sweeps = 0;      // Sweep-line: >1 without sweepDistinct, states counts a marking once per sweep
+};
+
+// BuDDy kernel parameters chosen by bddReach from the model size (tuneBddKernel)
+struct BddKernelParams {
+    int nodes = 0;          // Initial node-table size
+    int cacheSize = 0;      // Initial entries per operator cache
+    int cacheRatio = 0;     // Node-table / cache-size ratio kept when the table grows
+    int maxIncrease = 0;    // Max nodes added by one node-table resize
+    int minFreePct = 0;     // Grow the table when a GC frees less than this %
+};
+
+// BuDDy kernel activity during one bddReach (GC, node-table resizes, operator caches)
+struct BddTelemetry {
+    static const int CACHE_KINDS = 6;   // apply, ite, quant, appex, replace, misc
+
+    int gcCount = 0;
+    double gcTimeSec = 0.0;             // Wall time spent inside garbage collections
+    int resizeCount = 0;                // Node-table resizes
+    int peakLiveNodes = 0;              // Most occupied table nodes, sampled before each GC and at the end
+    double cacheHitRate[CACHE_KINDS] = {-1, -1, -1, -1, -1, -1};  // -1 = cache not used
 };
 
 struct BddResult {
@@ -52,6 +78,11 @@ struct BddResult {
     double memMB = 0.0;
     int nodeCount = 0;
     int iters = 0;
+    bool fromCache = false;         // Reached was loaded from the on-disk cache
+    bool complete = true;           // false: memory limit hit or net not bounded by tokenBound
+    int tokenBound = 1;             // k of the encoding: bitsForBound(k) BDD variables per place
+    BddKernelParams kernel;
+    BddTelemetry telemetry;
     void* internalState = nullptr;  // Stores BDD root for ILP reachability checks
 };
 
@@ -64,6 +95,22 @@ struct IlpResult {
     double timeSec = 0.0;
 };
 
+// Binary digits needed to store 0..k tokens
+inline int bitsForBound(int k) {
+    int bits = 1;
+    while ((1 << bits) - 1 < k) ++bits;
+    return bits;
+}
+
+// Smallest bound worth trying: the largest initial marking or arc weight (at least 1)
+inline int initialTokenBound(const Model& net) {
+    int k = 1;
+    for (Token m : net.M0) k = max(k, (int)m);
+    for (const auto& row : net.Pre)  for (int w : row) k = max(k, w);
+    for (const auto& row : net.Post) for (int w : row) k = max(k, w);
+    return min(k, MAX_TOKENS);
+}
+
 // Marking comparison & hashing
 inline bool operator==(const Marking& a, const Marking& b) {
     return a.size() == b.size() && equal(a.begin(), a.end(), b.begin());
@@ -78,6 +125,29 @@ struct MarkingHash {
     }
 };
 
+// FNV-1a 64-bit hash over raw bytes; pass the previous result as h to chain
+constexpr uint64_t FNV_OFFSET = 1469598103934665603ULL;
+inline uint64_t fnv1a(const void* data, size_t n, uint64_t h = FNV_OFFSET) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < n; ++i) {
+        h ^= bytes[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// Structural hash of a model (names, Pre/Post, M0); keys on-disk caches
+inline uint64_t modelHash(const Model& net) {
+    uint64_t h = FNV_OFFSET;
+    uint64_t dims[2] = { net.places.size(), net.transitions.size() };
+    h = fnv1a(dims, sizeof(dims), h);
+    for (const auto& s : net.places)      h = fnv1a(s.c_str(), s.size() + 1, h);
+    for (const auto& s : net.transitions) h = fnv1a(s.c_str(), s.size() + 1, h);
+    for (const auto& row : net.Pre)  h = fnv1a(row.data(), row.size() * sizeof(int), h);
+    for (const auto& row : net.Post) h = fnv1a(row.data(), row.size() * sizeof(int), h);
+    return fnv1a(net.M0.data(), net.M0.size(), h);
+}
+
 inline string toString(const Marking& M) {
     ostringstream oss;
     oss << "[";
@@ -1,7 +1,9 @@
 #include <iostream>
 #include <cassert>
+#include <cstdio>
 #include "bdd.h" // Code của Khoa
 #include "utils.h"
+#include "buddy/bdd.h"
 
 Model createDiamondModel() {
     Model m;
@@ -28,6 +30,64 @@ Model createDiamondModel() {
     return m;
 }
 
+// p0 -> t0 -> p1 -> ... -> p(n-1): n reachable states
+Model createChainModel(int n) {
+    Model m;
+    for (int i = 0; i < n; ++i) m.places.push_back("p" + to_string(i));
+    for (int i = 0; i + 1 < n; ++i) m.transitions.push_back("t" + to_string(i));
+    m.Pre.assign(n, vector<int>(n - 1, 0));
+    m.Post.assign(n, vector<int>(n - 1, 0));
+    for (int i = 0; i + 1 < n; ++i) {
+        m.Pre[i][i] = 1;
+        m.Post[i + 1][i] = 1;
+    }
+    m.M0.assign(n, 0);
+    m.M0[0] = 1;
+    return m;
+}
+
+// Mạng có trọng số (không 1-safe): t0 lấy 2 token ở p0, đặt 3 token vào p1;
+// t1 rút từng token khỏi p1. p1 lên tới 6 token, có 12 trạng thái đạt được
+Model createWeightedModel() {
+    Model m;
+    m.places = {"p0", "p1"};
+    m.transitions = {"t0", "t1"};
+    m.Pre.assign(2, vector<int>(2, 0));
+    m.Post.assign(2, vector<int>(2, 0));
+    m.Pre[0][0] = 2; m.Post[1][0] = 3;
+    m.Pre[1][1] = 1;
+    m.M0 = {4, 0};
+    return m;
+}
+
+// n triết gia lấy đũa trái rồi phải: BDD của tập đạt được lớn nhanh theo n
+Model createPhilosophersModel(int n) {
+    Model m;
+    m.places.resize(4 * n);
+    m.Pre.assign(4 * n, vector<int>(3 * n, 0));
+    m.Post.assign(4 * n, vector<int>(3 * n, 0));
+    m.M0.assign(4 * n, 0);
+    for (int i = 0; i < n; ++i) {
+        int think = 4 * i, hasLeft = think + 1, eat = think + 2, fork = think + 3;
+        int right = 4 * ((i + 1) % n) + 3;
+        m.places[think] = "think" + to_string(i);
+        m.places[hasLeft] = "hasLeft" + to_string(i);
+        m.places[eat] = "eat" + to_string(i);
+        m.places[fork] = "fork" + to_string(i);
+        m.M0[think] = m.M0[fork] = 1;
+        m.transitions.push_back("takeLeft" + to_string(i));
+        m.transitions.push_back("takeRight" + to_string(i));
+        m.transitions.push_back("release" + to_string(i));
+        m.Pre[think][3 * i] = m.Pre[fork][3 * i] = 1;
+        m.Post[hasLeft][3 * i] = 1;
+        m.Pre[hasLeft][3 * i + 1] = m.Pre[right][3 * i + 1] = 1;
+        m.Post[eat][3 * i + 1] = 1;
+        m.Pre[eat][3 * i + 2] = 1;
+        m.Post[think][3 * i + 2] = m.Post[fork][3 * i + 2] = m.Post[right][3 * i + 2] = 1;
+    }
+    return m;
+}
+
 int main() {
     Model m = createDiamondModel();
     BddOptions opts;
@@ -58,12 +118,186 @@ int main() {
     assert(bdd_check_reachable(res, m1, 4) == true);
     assert(bdd_check_reachable(res, m2, 4) == true);
     assert(bdd_check_reachable(res, m3, 4) == false);
+
+    // Batch: cùng kết quả với từng lần gọi, theo đúng thứ tự đầu vào
+    vector<bool> hits = bdd_check_reachable_batch(res, {m3, m0, m2, m3, m1}, 4);
+    assert(hits == vector<bool>({false, true, true, false, true}));
+    assert(bdd_check_reachable_batch(res, {}, 4).empty());
     
     cout << "   -> bdd_check_reachable: OK" << endl;
 
     // Cleanup
     bdd_cleanup(res);
 
+    // Test persistent Reached cache: lần 2 phải load từ file, không chạy fixpoint
+    cout << "Testing BDD reach cache..." << endl;
+    BddOptions cacheOpts;
+    cacheOpts.cacheDir = ".";
+    BddResult first = bddReach(m, cacheOpts);
+    BddResult second = bddReach(m, cacheOpts);
+    assert(second.fromCache);
+    assert(second.states == first.states && second.iters == first.iters);
+    assert(bdd_check_reachable(second, m2, 4) == true);
+    assert(bdd_check_reachable(second, m3, 4) == false);
+
+    // Binary BDD format: load lại phải ra đúng node cũ (BDD canonical)
+    int firstRoot = *static_cast<int*>(first.internalState);
+    [[maybe_unused]] int saved = bdd_fnsavebin((char*)"test_reach.bddb", firstRoot);
+    assert(saved == 0);
+    int loadedRoot = -1;
+    [[maybe_unused]] int loaded = bdd_fnloadbin((char*)"test_reach.bddb", &loadedRoot);
+    assert(loaded == 0);
+    assert(loadedRoot == firstRoot);
+    remove("test_reach.bddb");
+    bdd_cleanup(first);
+    bdd_cleanup(second);
+
+    char cacheName[40];
+    snprintf(cacheName, sizeof(cacheName), "./reach-%016llx.bdd", (unsigned long long)modelHash(m));
+    remove(cacheName);
+    cout << "   -> reach cache: OK" << endl;
+
+    // Batch mode giữ BuDDy chạy giữa các model có số biến khác nhau
+    cout << "Testing BDD kernel reuse across models..." << endl;
+    BddResult chain = bddReach(createChainModel(8), opts);
+    assert(chain.states == 8);
+    bdd_cleanup(chain);
+    BddResult again = bddReach(m, opts);
+    assert(again.states == 3);
+    bdd_cleanup(again);
+    cout << "   -> kernel reuse: OK" << endl;
+
+    // Image song song qua worker process phải cho cùng kết quả
+    cout << "Testing parallel image workers..." << endl;
+    BddOptions parOpts;
+    parOpts.workers = 3;
+    BddResult seqChain = bddReach(createChainModel(12), opts);
+    BddResult parChain = bddReach(createChainModel(12), parOpts);
+    assert(parChain.states == seqChain.states && parChain.iters == seqChain.iters);
+    bdd_cleanup(seqChain);
+    bdd_cleanup(parChain);
+    cout << "   -> parallel image: OK" << endl;
+
+    // Phủ định: !(!f) phải trả về đúng node cũ (BDD canonical)
+    bdd f = (bdd_ithvar(0) & bdd_nithvar(2)) | bdd_ithvar(4);
+    bdd notF = !f;
+    assert((!notF) == f);
+    assert((f & notF) == bdd_false() && (f | notF) == bdd_true());
+    cout << "   -> negation: OK" << endl;
+
+    // Telemetry: hit rate nằm trong [0,1], hoặc -1 nếu cache không được dùng
+    cout << "Testing BDD telemetry..." << endl;
+    BddResult tele = bddReach(createChainModel(10), opts);
+    assert(tele.telemetry.gcCount >= 0 && tele.telemetry.gcTimeSec >= 0.0);
+    assert(tele.telemetry.peakLiveNodes >= tele.nodeCount);
+    for ([[maybe_unused]] double rate : tele.telemetry.cacheHitRate)
+        assert(rate == -1 || (rate >= 0.0 && rate <= 1.0));
+#ifdef CACHESTATS
+    assert(tele.telemetry.cacheHitRate[bddcache_appex] >= 0.0);
+#endif
+    bdd_cleanup(tele);
+    cout << "   -> telemetry: OK" << endl;
+
+    // Kích thước kernel: net nhỏ không cấp bảng cỡ triệu node; budget được tôn trọng
+    cout << "Testing BDD kernel sizing..." << endl;
+    [[maybe_unused]] BddKernelParams small = tuneBddKernel(m, 1, 0);
+    [[maybe_unused]] BddKernelParams large = tuneBddKernel(createChainModel(200), 1, 0);
+    assert(small.nodes < 100000 && small.nodes <= large.nodes);
+    assert(small.cacheSize > 0 && small.maxIncrease > 0);
+    // Bound lớn hơn thì mỗi place cần nhiều biến hơn, bảng node phải lớn hơn
+    [[maybe_unused]] BddKernelParams wide = tuneBddKernel(createChainModel(20), 255, 0);
+    assert(wide.nodes > tuneBddKernel(createChainModel(20), 1, 0).nodes);
+    [[maybe_unused]] BddKernelParams capped = tuneBddKernel(createChainModel(200), 1, 4.0);
+    assert(capped.nodes < large.nodes);
+    assert(capped.nodes * 20.0 + 6 * capped.cacheSize * 24.0 <= 4.0 * 1024 * 1024);
+    cout << "   -> kernel sizing: OK" << endl;
+
+    // Giới hạn bộ nhớ: hết node thì trả về kết quả dở dang thay vì crash
+    cout << "Testing BDD memory limit..." << endl;
+    BddResult full = bddReach(m, opts);
+    assert(full.complete);
+    bdd_cleanup(full);
+    BddOptions tight = opts;
+    tight.memLimitMB = 0.01;
+    BddResult partial = bddReach(createPhilosophersModel(40), tight);
+    assert(!partial.complete);
+    assert(partial.states >= 1);
+    bdd_cleanup(partial);
+    cout << "   -> memory limit: OK" << endl;
+
+    // Đếm trạng thái: số đếm cộng dồn từ new_diff khớp với satcount của Reached,
+    // và satcount gọi lại nhiều lần vẫn cho cùng kết quả
+    cout << "Testing incremental state count..." << endl;
+    Model phil = createPhilosophersModel(5);
+    BddResult counted = bddReach(phil, opts);
+    BDD reachedRoot = *static_cast<int*>(counted.internalState);
+    bdd xVars = bdd_true();
+    for (size_t i = 0; i < phil.places.size(); ++i) xVars &= bdd_ithvar(2 * i);
+    [[maybe_unused]] double direct = bdd_satcountset(reachedRoot, xVars.id());
+    assert(counted.states == (size_t)direct);
+    assert(bdd_satcountset(reachedRoot, xVars.id()) == direct);
+    assert(bdd_satcount(bdd_ithvar(0) | bdd_ithvar(1)) == 3 * bdd_satcount(bdd_ithvar(0) & bdd_ithvar(1)));
+    bdd_cleanup(counted);
+    cout << "   -> incremental count: OK" << endl;
+
+    // k-bounded: cận ban đầu (4) bị vượt nên được nới rộng, kết quả khớp explicit
+    cout << "Testing k-bounded encoding..." << endl;
+    Model weighted = createWeightedModel();
+    BddResult kb = bddReach(weighted, opts);
+    assert(kb.complete && kb.states == 12);
+    assert(kb.tokenBound >= 6);
+    assert(bdd_check_reachable(kb, {0, 6}, 2));
+    assert(bdd_check_reachable(kb, {2, 3}, 2));
+    assert(!bdd_check_reachable(kb, {1, 0}, 2));
+    assert(!bdd_check_reachable(kb, {2, 4}, 2));
+    assert(!bdd_check_reachable(kb, {0, 16}, 2));
+    bdd_cleanup(kb);
+    BddOptions fixed = opts;
+    fixed.tokenBound = 4;
+    BddResult overflowed = bddReach(weighted, fixed);
+    assert(!overflowed.complete);
+    bdd_cleanup(overflowed);
+    cout << "   -> k-bounded: OK" << endl;
+
+    // Thứ tự biến khác (cả khi cận được nới rộng) không đổi tập trạng thái
+    cout << "Testing place variable order..." << endl;
+    BddOptions reversed = opts;
+    reversed.placeOrder = {3, 2, 1, 0};
+    BddResult rev = bddReach(m, reversed);
+    assert(rev.states == 3);
+    assert(bdd_check_reachable(rev, m1, 4) && !bdd_check_reachable(rev, m3, 4));
+    bdd_cleanup(rev);
+    reversed.placeOrder = {1, 0};
+    BddResult revKb = bddReach(weighted, reversed);
+    assert(revKb.complete && revKb.states == 12);
+    assert(bdd_check_reachable(revKb, {0, 6}, 2) && !bdd_check_reachable(revKb, {2, 4}, 2));
+    bdd_cleanup(revKb);
+    cout << "   -> place order: OK" << endl;
+
+    // Checkpoint: dừng sau 3 vòng (giữ checkpoint), chạy tiếp từ đó ra cùng kết quả
+    cout << "Testing fixpoint checkpoint/resume..." << endl;
+    Model longChain = createChainModel(8);
+    BddResult fullChain = bddReach(longChain, opts);
+    BddOptions ckptOpts = opts;
+    ckptOpts.checkpointDir = ".";
+    ckptOpts.maxIters = 3;
+    BddResult stopped = bddReach(longChain, ckptOpts);
+    assert(!stopped.complete && stopped.states < fullChain.states);
+    char ckptName[40];
+    snprintf(ckptName, sizeof(ckptName), "./bdd-%016llx.ckpt", (unsigned long long)modelHash(longChain));
+    FILE* ckptFile = fopen(ckptName, "rb");
+    assert(ckptFile != nullptr);
+    fclose(ckptFile);
+    ckptOpts.maxIters = opts.maxIters;
+    ckptOpts.resume = true;
+    BddResult resumed = bddReach(longChain, ckptOpts);
+    assert(resumed.complete && resumed.states == fullChain.states && resumed.iters == fullChain.iters);
+    assert(fopen(ckptName, "rb") == nullptr);  // Đã xong: checkpoint bị xóa
+    bdd_cleanup(fullChain);
+    bdd_cleanup(stopped);
+    bdd_cleanup(resumed);
+    cout << "   -> checkpoint/resume: OK" << endl;
+
     cout << "✅ [PASS] BDD Symbolic hoat dong dung!" << endl;
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,90 @@
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include "coverability.h"
+#include "utils.h"
+
+Model createDiamondModel() {
+    Model m;
+    m.places = {"p0", "p1", "p2", "p3"};
+    m.transitions = {"t0", "t1"};
+    m.Pre.assign(4, vector<int>(2, 0));
+    m.Post.assign(4, vector<int>(2, 0));
+    // t0: p0 -> {p1, p2}; t1: {p1, p2} -> p3
+    m.Pre[0][0] = 1;
+    m.Post[1][0] = 1; m.Post[2][0] = 1;
+    m.Pre[1][1] = 1; m.Pre[2][1] = 1;
+    m.Post[3][1] = 1;
+    m.M0 = {1, 0, 0, 0};
+    return m;
+}
+
+// Producer: t0 giữ token ở p0 và sinh thêm 1 token vào p1 (không bị chặn),
+// t1 chuyển p0 -> p2 để dừng
+Model createProducerModel() {
+    Model m;
+    m.places = {"p0", "p1", "p2"};
+    m.transitions = {"t0", "t1"};
+    m.Pre.assign(3, vector<int>(2, 0));
+    m.Post.assign(3, vector<int>(2, 0));
+    m.Pre[0][0] = 1; m.Post[0][0] = 1; m.Post[1][0] = 1;
+    m.Pre[0][1] = 1; m.Post[2][1] = 1;
+    m.M0 = {1, 0, 0};
+    return m;
+}
+
+// Mạng có trọng số, bị chặn: p1 lên tới 6 token
+Model createWeightedModel() {
+    Model m;
+    m.places = {"p0", "p1"};
+    m.transitions = {"t0", "t1"};
+    m.Pre.assign(2, vector<int>(2, 0));
+    m.Post.assign(2, vector<int>(2, 0));
+    m.Pre[0][0] = 2; m.Post[1][0] = 3;
+    m.Pre[1][1] = 1;
+    m.M0 = {4, 0};
+    return m;
+}
+
+static bool inSet(const CoverResult& res, const OmegaMarking& M) {
+    return find(res.mcs.begin(), res.mcs.end(), M) != res.mcs.end();
+}
+
+int main() {
+    CoverOptions opts;
+
+    cout << "Testing coverability of a bounded net..." << endl;
+    CoverResult diamond = coverability(createDiamondModel(), opts);
+    assert(diamond.complete && diamond.bounded);
+    assert(diamond.mcs.size() == 3);  // {p0}, {p1,p2}, {p3} không so sánh được
+    assert((diamond.placeBound == vector<int>{1, 1, 1, 1}));
+    cout << "   -> bounded: OK" << endl;
+
+    cout << "Testing coverability of an unbounded net..." << endl;
+    CoverResult producer = coverability(createProducerModel(), opts);
+    assert(producer.complete && !producer.bounded);
+    assert(producer.mcs.size() == 2);
+    assert(inSet(producer, {1, OMEGA, 0}));
+    assert(inSet(producer, {0, OMEGA, 1}));
+    assert((producer.placeBound == vector<int>{1, OMEGA, 1}));
+    cout << "   -> omega: OK" << endl;
+
+    // Cận từng place của mạng k-bounded: chỉ giữ các marking cực đại
+    cout << "Testing place bounds of a weighted net..." << endl;
+    CoverResult weighted = coverability(createWeightedModel(), opts);
+    assert(weighted.complete && weighted.bounded);
+    assert((weighted.placeBound == vector<int>{4, 6}));
+    assert(weighted.mcs.size() == 3);
+    assert(inSet(weighted, {4, 0}) && inSet(weighted, {2, 3}) && inSet(weighted, {0, 6}));
+    cout << "   -> place bounds: OK" << endl;
+
+    cout << "Testing node limit..." << endl;
+    CoverOptions capped;
+    capped.maxNodes = 1;
+    CoverResult part = coverability(createProducerModel(), capped);
+    assert(!part.complete && part.explored == 1);
+    cout << "   -> node limit: OK" << endl;
+
+    cout << "✅ [PASS] Coverability (Karp-Miller) hoat dong dung!" << endl;
+    return 0;
+}
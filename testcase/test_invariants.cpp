@@ -0,0 +1,155 @@
+#include <iostream>
+#include <cassert>
+#include "invariants.h"
+#include "utils.h"
+
+Model emptyModel(int P, int T) {
+    Model m;
+    for (int i = 0; i < P; ++i) m.places.push_back("p" + to_string(i));
+    for (int i = 0; i < T; ++i) m.transitions.push_back("t" + to_string(i));
+    m.Pre.assign(P, vector<int>(T, 0));
+    m.Post.assign(P, vector<int>(T, 0));
+    m.M0.assign(P, 0);
+    return m;
+}
+
+// t0: p0 -> {p1, p2}; t1: {p1, p2} -> p3
+Model createDiamondModel() {
+    Model m = emptyModel(4, 2);
+    m.Pre[0][0] = 1; m.Post[1][0] = 1; m.Post[2][0] = 1;
+    m.Pre[1][1] = 1; m.Pre[2][1] = 1; m.Post[3][1] = 1;
+    m.M0[0] = 1;
+    return m;
+}
+
+// Vòng p0 -t0-> p1 -t1-> p2 -t2-> p0
+Model createCycleModel() {
+    Model m = emptyModel(3, 3);
+    for (int i = 0; i < 3; ++i) {
+        m.Pre[i][i] = 1;
+        m.Post[(i + 1) % 3][i] = 1;
+    }
+    m.M0[0] = 1;
+    return m;
+}
+
+// t0 lấy 2 token từ p0, đặt 3 token vào p1; t1 trả 3 token p1 -> 2 token p0
+Model createWeightedModel() {
+    Model m = emptyModel(2, 2);
+    m.Pre[0][0] = 2; m.Post[1][0] = 3;
+    m.Pre[1][1] = 3; m.Post[0][1] = 2;
+    m.M0 = {4, 0};
+    return m;
+}
+
+// y·C = 0 (P) hoặc C·x = 0 (T), hệ số dương
+static bool isSemiflow(const Model& m, const Invariant& inv, bool place) {
+    size_t cols = place ? m.transitions.size() : m.places.size();
+    for (size_t c = 0; c < cols; ++c) {
+        long long sum = 0;
+        for (const auto& term : inv.terms) {
+            assert(term.second > 0);
+            int p = place ? term.first : (int)c, t = place ? (int)c : term.first;
+            sum += (long long)term.second * (m.Post[p][t] - m.Pre[p][t]);
+        }
+        if (sum != 0) return false;
+    }
+    return true;
+}
+
+static bool hasInvariant(const InvariantResult& res, const vector<pair<int, int>>& terms) {
+    for (const auto& inv : res.invariants)
+        if (inv.terms == terms) return true;
+    return false;
+}
+
+int main() {
+    cout << "Testing P-invariants of the diamond..." << endl;
+    Model diamond = createDiamondModel();
+    InvariantResult p = computePInvariants(diamond);
+    assert(p.complete && p.invariants.size() == 2);
+    assert(hasInvariant(p, {{0, 1}, {1, 1}, {3, 1}}));
+    assert(hasInvariant(p, {{0, 1}, {2, 1}, {3, 1}}));
+    for ([[maybe_unused]] const auto& inv : p.invariants) {
+        assert(isSemiflow(diamond, inv, true));
+        assert(inv.value == 1);
+    }
+    assert(coveredByInvariants(p.invariants, 4));
+    assert(computeTInvariants(diamond).invariants.empty());
+    assert(toString(p.invariants[0], diamond.places, true) == "p0 + p1 + p3 = 1" ||
+           toString(p.invariants[0], diamond.places, true) == "p0 + p2 + p3 = 1");
+    cout << "   -> diamond: OK" << endl;
+
+    cout << "Testing the cycle..." << endl;
+    Model cycle = createCycleModel();
+    InvariantResult cp = computePInvariants(cycle), ct = computeTInvariants(cycle);
+    assert(cp.invariants.size() == 1 && hasInvariant(cp, {{0, 1}, {1, 1}, {2, 1}}));
+    assert(ct.invariants.size() == 1 && hasInvariant(ct, {{0, 1}, {1, 1}, {2, 1}}));
+    assert(isSemiflow(cycle, ct.invariants[0], false));
+    cout << "   -> cycle: OK" << endl;
+
+    cout << "Testing weighted arcs..." << endl;
+    Model weighted = createWeightedModel();
+    InvariantResult wp = computePInvariants(weighted), wt = computeTInvariants(weighted);
+    assert(wp.invariants.size() == 1 && hasInvariant(wp, {{0, 3}, {1, 2}}));
+    assert(wp.invariants[0].value == 12);
+    assert(wt.invariants.size() == 1 && hasInvariant(wt, {{0, 1}, {1, 1}}));
+    cout << "   -> weighted: OK" << endl;
+
+    // p1 không thuộc invariant nào (t1 sinh thêm token) nên đứng cuối thứ tự biến
+    cout << "Testing place order..." << endl;
+    Model open = emptyModel(3, 2);
+    open.Pre[0][0] = 1; open.Post[2][0] = 1; open.Post[1][0] = 1;
+    open.Post[1][1] = 1;
+    InvariantResult op = computePInvariants(open);
+    assert(op.invariants.size() == 1 && !coveredByInvariants(op.invariants, 3));
+    assert((invariantPlaceOrder(op.invariants, 3) == vector<int>{0, 2, 1}));
+    cout << "   -> place order: OK" << endl;
+
+    // 3*p0 + 2*p1 = 12: chỉ lưu một place, place kia dựng lại bằng phép chia
+    cout << "Testing place basis..." << endl;
+    PlaceBasis basis(2, wp.invariants);
+    assert(basis.size() == 1 && basis.implied() == 1);
+    for (Marking M : {Marking{4, 0}, Marking{2, 3}, Marking{0, 6}}) {
+        Marking B = basis.compress(M);
+        assert(B.size() == 1 && basis.expand(B) == M);
+    }
+    // Diamond: hai invariant độc lập, 2 trong 4 place được lưu
+    PlaceBasis diamondBasis(4, p.invariants);
+    assert(diamondBasis.size() == 2);
+    for (Marking M : {Marking{1, 0, 0, 0}, Marking{0, 1, 1, 0}, Marking{0, 0, 0, 1}})
+        assert(diamondBasis.expand(diamondBasis.compress(M)) == M);
+    // Không có invariant: marking giữ nguyên
+    PlaceBasis none(3, {});
+    assert(none.size() == 3 && none.compress({1, 2, 3}) == Marking({1, 2, 3}));
+    cout << "   -> place basis: OK" << endl;
+
+    cout << "Testing the row limit..." << endl;
+    InvariantOptions tiny;
+    tiny.maxRows = 1;
+    InvariantResult cut = computePInvariants(diamond, tiny);
+    assert(!cut.complete && cut.invariants.empty());
+    cout << "   -> row limit: OK" << endl;
+
+    // Chuỗi t_i: 2 token p_i -> 1 token p_{i+1}: invariant duy nhất có hệ số 2^i
+    cout << "Testing coefficient overflow..." << endl;
+    auto doublingChain = [](int P) {
+        Model m = emptyModel(P, P - 1);
+        for (int i = 0; i + 1 < P; ++i) { m.Pre[i][i] = 2; m.Post[i + 1][i] = 1; }
+        return m;
+    };
+    Model shortChain = doublingChain(20);
+    InvariantResult fits = computePInvariants(shortChain);
+    assert(fits.complete && fits.invariants.size() == 1);
+    assert(isSemiflow(shortChain, fits.invariants[0], true));
+    assert(fits.invariants[0].terms.back().second == 1 << 19);
+    // 2^34 không vừa int: không được trả về invariant sai, kết quả đánh dấu chưa đủ
+    Model longChain = doublingChain(35);
+    InvariantResult big = computePInvariants(longChain);
+    assert(!big.complete);
+    for ([[maybe_unused]] const Invariant& inv : big.invariants) assert(isSemiflow(longChain, inv, true));
+    cout << "   -> overflow: OK" << endl;
+
+    cout << "✅ [PASS] P-/T-invariants hoat dong dung!" << endl;
+    return 0;
+}
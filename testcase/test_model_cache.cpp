@@ -0,0 +1,86 @@
+#include <iostream>
+#include <fstream>
+#include <cassert>
+#include <cstddef>
+#include "model_cache.h"
+#include "utils.h"
+
+int main() {
+    // 1. Tạo file PNML mẫu (p1 -> t1 -> p2, arc weight 2 trên Post)
+    std::ofstream out("test_cache.pnml");
+    out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        << "<pnml><net><page>\n"
+        << " <place id=\"p1\"><initialMarking><text>1</text></initialMarking></place>\n"
+        << " <place id=\"p2\"></place>\n"
+        << " <transition id=\"t1\"></transition>\n"
+        << " <arc id=\"a1\" source=\"p1\" target=\"t1\"/>\n"
+        << " <arc id=\"a2\" source=\"t1\" target=\"p2\"><inscription><text>2</text></inscription></arc>\n"
+        << "</page></net></pnml>";
+    out.close();
+
+    try {
+        cout << "Testing Model Cache..." << endl;
+        std::string cachePath = modelCachePath("test_cache.pnml");
+        remove(cachePath.c_str());
+
+        // 2. Lần đầu: parse XML và ghi cache
+        Model parsed = loadModel("test_cache.pnml", true, false);
+        std::ifstream check(cachePath, std::ios::binary);
+        assert(check.good());
+        check.close();
+
+        // 3. Mở cache trực tiếp qua view
+        CompiledModel cm;
+        [[maybe_unused]] bool opened = cm.open(cachePath, fileChecksum("test_cache.pnml"));
+        assert(opened);
+        assert(cm.numPlaces() == 2 && cm.numTransitions() == 1);
+        assert(cm.placeName(0) == "p1" && cm.transitionName(0) == "t1");
+        assert(cm.postRowPtr[1] == 1 && cm.postW[0] == 2);
+
+        // 4. Checksum sai -> cache bị từ chối
+        CompiledModel stale;
+        assert(!stale.open(cachePath, 12345));
+
+        // 5. Lần hai: load từ cache phải giống hệt parse
+        Model cached = loadModel("test_cache.pnml", true, false);
+        assert(cached.places == parsed.places);
+        assert(cached.transitions == parsed.transitions);
+        assert(cached.Pre == parsed.Pre);
+        assert(cached.Post == parsed.Post);
+        assert(cached.M0 == parsed.M0);
+        assert(cached.arcCount == parsed.arcCount);
+        assert(cached.placeIndex == parsed.placeIndex);
+
+        // 5b. Cache của phiên bản cũ (parser kiểm tra khác) -> bị từ chối
+        {
+            std::fstream f(cachePath, std::ios::binary | std::ios::in | std::ios::out);
+            uint32_t oldVersion = MODEL_CACHE_VERSION - 1;
+            f.seekp(offsetof(CacheHeader, version));
+            f.write(reinterpret_cast<const char*>(&oldVersion), sizeof(oldVersion));
+        }
+        CompiledModel old;
+        [[maybe_unused]] bool oldOpened = old.open(cachePath, fileChecksum("test_cache.pnml"));
+        assert(!oldOpened);
+        loadModel("test_cache.pnml", true, false);  // Ghi lại cache với phiên bản hiện tại
+
+        // 6. Offset hỏng (không đơn điệu) -> bị từ chối, loadModel parse lại
+        {
+            std::fstream f(cachePath, std::ios::binary | std::ios::in | std::ios::out);
+            uint32_t bad = 1000;
+            f.seekp((sizeof(CacheHeader) + 7) / 8 * 8 + sizeof(uint32_t));  // strOffsets[1]
+            f.write(reinterpret_cast<const char*>(&bad), sizeof(bad));
+        }
+        CompiledModel corrupt;
+        assert(!corrupt.open(cachePath, fileChecksum("test_cache.pnml")));
+        Model reparsed = loadModel("test_cache.pnml", true, false);
+        assert(reparsed.places == parsed.places);
+
+        cout << "✅ [PASS] Model cache round-trip chính xác!" << endl;
+        remove(cachePath.c_str());
+        remove("test_cache.pnml");
+    } catch (const exception& e) {
+        cerr << "❌ [FAIL] Model cache lỗi: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -28,6 +28,35 @@ Model createDiamondModel() {
     return m;
 }
 
+// Mạng có trọng số (không 1-safe): t0 lấy 2 token ở p0, đặt 3 token vào p1;
+// t1 rút từng token khỏi p1. p1 lên tới 6 token, có 12 trạng thái đạt được
+Model createWeightedModel() {
+    Model m;
+    m.places = {"p0", "p1"};
+    m.transitions = {"t0", "t1"};
+    m.Pre.assign(2, vector<int>(2, 0));
+    m.Post.assign(2, vector<int>(2, 0));
+    m.Pre[0][0] = 2; m.Post[1][0] = 3;
+    m.Pre[1][1] = 1;
+    m.M0 = {4, 0};
+    return m;
+}
+
+// Vòng 3 place, token bắt đầu ở p1
+Model createCycleModel() {
+    Model m;
+    m.places = {"p0", "p1", "p2"};
+    m.transitions = {"t0", "t1", "t2"};
+    m.Pre.assign(3, vector<int>(3, 0));
+    m.Post.assign(3, vector<int>(3, 0));
+    for (int t = 0; t < 3; ++t) {
+        m.Pre[t][t] = 1;
+        m.Post[(t + 1) % 3][t] = 1;
+    }
+    m.M0 = {0, 1, 0};
+    return m;
+}
+
 int main() {
     Model m = createDiamondModel();
     ReachOptions opts;
@@ -46,6 +75,125 @@ int main() {
     assert(res.timeSec >= 0.0);
     assert(res.memMB >= 0.0);
 
+    // Giới hạn số trạng thái: dừng sớm và đánh dấu kết quả chưa đầy đủ
+    assert(res.complete);
+    ReachOptions capped = opts;
+    capped.maxStates = 2;
+    [[maybe_unused]] ReachResult part = explicitReach(m, capped);
+    assert(!part.complete && part.states == 2);
+
+    // Mạng k-bounded: token được đếm đầy đủ, không bị cắt về 0/1
+    [[maybe_unused]] ReachResult weighted = explicitReach(createWeightedModel(), opts);
+    assert(weighted.complete && weighted.states == 12);
+
+    // Chỉ lưu các place không bị P-invariant xác định: cùng số trạng thái với BFS và DFS
+    ReachOptions compressed = opts;
+    Invariant a, b;
+    a.terms = {{0, 1}, {1, 1}, {3, 1}};
+    b.terms = {{0, 1}, {2, 1}, {3, 1}};
+    a.value = b.value = 1;
+    compressed.invariants = {a, b};
+    assert(explicitReach(m, compressed).states == 3);
+    compressed.useBFS = false;
+    assert(explicitReach(m, compressed).states == 3);
+
+    // Lưu xấp xỉ: fingerprint 64 bit / Bloom filter rộng không bỏ sót trên mạng nhỏ,
+    // xác suất bỏ sót ước lượng > 0 nhưng rất nhỏ
+    ReachOptions compact = opts;
+    compact.store = StateStore::HASH_COMPACT;
+    [[maybe_unused]] ReachResult hc = explicitReach(createWeightedModel(), compact);
+    assert(hc.complete && hc.states == 12);
+    assert(hc.omissionProb > 0 && hc.omissionProb < 1e-15);
+    ReachOptions bitstate = opts;
+    bitstate.store = StateStore::BITSTATE;
+    bitstate.useBFS = false;
+    [[maybe_unused]] ReachResult bs = explicitReach(createWeightedModel(), bitstate);
+    assert(bs.complete && bs.states == 12 && bs.omissionProb < 1e-9);
+
+    // Fingerprint 4 bit: chỉ 16 giá trị cho 12 marking, bỏ sót và báo xác suất cao
+    compact.bitsPerState = 4;
+    [[maybe_unused]] ReachResult lossy = explicitReach(createWeightedModel(), compact);
+    assert(lossy.states < 12 && lossy.omissionProb > 0.5);
+
+    // Giới hạn số trạng thái vẫn áp dụng cho hash compaction
+    compact.bitsPerState = 0;
+    compact.maxStates = 2;
+    [[maybe_unused]] ReachResult compactPart = explicitReach(m, compact);
+    assert(!compactPart.complete && compactPart.states == 2);
+
+    // BFS trên đĩa (duplicate detection trễ): cùng số trạng thái; bộ đệm 1 marking
+    // buộc mỗi successor thành một run riêng, kiểm tra phần trộn k run
+    ReachOptions disk = opts;
+    disk.diskDir = ".";
+    assert(explicitReach(m, disk).states == 3);
+    disk.diskBufferMB = 1e-9;
+    [[maybe_unused]] ReachResult diskWeighted = explicitReach(createWeightedModel(), disk);
+    assert(diskWeighted.complete && diskWeighted.states == 12);
+    disk.invariants = compressed.invariants;
+    assert(explicitReach(m, disk).states == 3);
+    disk.maxStates = 2;
+    [[maybe_unused]] ReachResult diskPart = explicitReach(m, disk);
+    assert(!diskPart.complete && diskPart.states == 2);
+
+    // Checkpoint: lần chạy bị cắt ở 5 marking để lại checkpoint, --resume chạy tiếp
+    // (phần log ghi sau checkpoint bị bỏ) và ra đủ 12 trạng thái; xong thì xóa checkpoint
+    for (bool onDisk : {false, true}) {
+        ReachOptions ckpt = opts;
+        ckpt.checkpointDir = ".";
+        if (onDisk) ckpt.diskDir = ".";
+        ckpt.maxStates = 5;
+        [[maybe_unused]] ReachResult stopped = explicitReach(createWeightedModel(), ckpt);
+        assert(!stopped.complete);
+        ckpt.maxStates = 0;
+        ckpt.resume = true;
+        [[maybe_unused]] ReachResult resumed = explicitReach(createWeightedModel(), ckpt);
+        assert(resumed.complete && resumed.states == 12);
+        [[maybe_unused]] ReachResult fresh = explicitReach(createWeightedModel(), ckpt);  // Không còn checkpoint
+        assert(fresh.complete && fresh.states == 12);
+    }
+
+    // Sweep-line: measure suy từ net tăng ngặt trên mạng không vòng, đếm đúng và
+    // xóa các marking đã quét qua (đỉnh bộ nhớ nhỏ hơn số trạng thái)
+    vector<long long> psi = progressMeasure(m);
+    for (size_t t = 0; t < m.transitions.size(); ++t) {
+        long long delta = 0;
+        for (size_t p = 0; p < m.places.size(); ++p) delta += psi[p] * (m.Post[p][t] - m.Pre[p][t]);
+        assert(delta > 0);
+    }
+    ReachOptions sweep = opts;
+    sweep.sweep = true;
+    [[maybe_unused]] ReachResult swept = explicitReach(createWeightedModel(), sweep);
+    assert(swept.complete && swept.states == 12 && swept.peakStored < 12);
+    assert(explicitReach(m, sweep).states == 3);
+
+    // Measure cho trước có cạnh lùi (p2 -> p0): đích được giữ và mở lượt quét thứ hai
+    sweep.progress = {0, 1, 2};
+    [[maybe_unused]] ReachResult regress = explicitReach(createCycleModel(), sweep);
+    assert(regress.complete && regress.states == 3);
+    sweep.maxStates = 2;
+    assert(!explicitReach(createCycleModel(), sweep).complete);
+
+    // Hai vòng độc lập (9 marking): lượt quét sau đi lại các marking đã xóa nên
+    // States là cận trên; --sweep-distinct đếm mỗi marking một lần
+    Model twoCycles;
+    twoCycles.places = {"a0", "a1", "a2", "b0", "b1", "b2"};
+    twoCycles.transitions = {"ta0", "ta1", "ta2", "tb0", "tb1", "tb2"};
+    twoCycles.Pre.assign(6, vector<int>(6, 0));
+    twoCycles.Post.assign(6, vector<int>(6, 0));
+    for (int c = 0; c < 2; ++c)
+        for (int i = 0; i < 3; ++i) {
+            twoCycles.Pre[3 * c + i][3 * c + i] = 1;
+            twoCycles.Post[3 * c + (i + 1) % 3][3 * c + i] = 1;
+        }
+    twoCycles.M0 = {1, 0, 0, 1, 0, 0};
+    sweep.maxStates = 0;
+    sweep.progress = {0, 1, 2, 0, 3, 6};
+    [[maybe_unused]] ReachResult twice = explicitReach(twoCycles, sweep);
+    assert(twice.complete && twice.sweeps > 1 && twice.states >= 9);
+    sweep.sweepDistinct = true;
+    [[maybe_unused]] ReachResult once = explicitReach(twoCycles, sweep);
+    assert(once.complete && once.states == 9 && once.omissionProb < 1e-9);
+
     cout << "✅ [PASS] Explicit BFS/DFS đếm đúng số trạng thái!" << endl;
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include <iostream>
+#include <cassert>
+#include "reduction.h"
+#include "reachability.h"
+#include "utils.h"
+
+// Mạng rỗng với P place, T transition (ma trận Pre/Post toàn 0)
+Model emptyModel(int P, int T) {
+    Model m;
+    for (int i = 0; i < P; ++i) m.places.push_back("p" + to_string(i));
+    for (int i = 0; i < T; ++i) m.transitions.push_back("t" + to_string(i));
+    m.Pre.assign(P, vector<int>(T, 0));
+    m.Post.assign(P, vector<int>(T, 0));
+    m.M0.assign(P, 0);
+    return m;
+}
+
+// p0 -> t0 -> p1 -> ... -> p(n-1): dừng (deadlock) ở p(n-1)
+Model createChainModel(int n) {
+    Model m = emptyModel(n, n - 1);
+    for (int i = 0; i + 1 < n; ++i) {
+        m.Pre[i][i] = 1;
+        m.Post[i + 1][i] = 1;
+    }
+    m.M0[0] = 1;
+    return m;
+}
+
+int main() {
+    cout << "Testing series fusion..." << endl;
+    Model chain = createChainModel(6);
+    Reduction red = reduceModel(chain, ReduceOptions());
+    assert(red.reduced.places.size() < chain.places.size());
+    [[maybe_unused]] ReachResult before = explicitReach(chain, ReachOptions());
+    [[maybe_unused]] ReachResult after = explicitReach(red.reduced, ReachOptions());
+    assert(after.states < before.states);
+    // Marking cuối của net rút gọn là deadlock, ánh xạ về đúng marking gốc
+    Marking last = red.reduced.M0;
+    for (size_t t = 0; t < red.reduced.transitions.size(); ++t)
+        if (isEnabled(red.reduced, last, t)) last = fire(red.reduced, last, t);
+    assert((red.expand(last) == Marking{0, 0, 0, 0, 0, 1}));
+    cout << "   -> series fusion: OK" << endl;
+
+    // Place được giữ lại không bị gộp: tập marking đạt được của nó giữ nguyên
+    cout << "Testing kept places..." << endl;
+    ReduceOptions keep;
+    keep.keepPlaces = {2};
+    Reduction kept = reduceModel(chain, keep);
+    assert(kept.reduced.placeIndex.count("p2"));
+    cout << "   -> kept places: OK" << endl;
+
+    // p1, p2 cùng cung vào/ra (p1 = p2 luôn đúng); t2 cần p3 không bao giờ có token;
+    // t3 là self-loop trên p0 mà t0 cần ít token hơn
+    cout << "Testing redundant places and dead transitions..." << endl;
+    Model m = emptyModel(5, 4);
+    m.Pre[0][0] = 1; m.Post[1][0] = 1; m.Post[2][0] = 1;   // t0: p0 -> p1, p2
+    m.Pre[1][1] = 1; m.Pre[2][1] = 1; m.Post[4][1] = 1;    // t1: p1, p2 -> p4
+    m.Pre[3][2] = 1; m.Post[0][2] = 1;                     // t2: p3 -> p0 (dead)
+    m.Pre[0][3] = 1; m.Post[0][3] = 1;                     // t3: p0 -> p0
+    m.M0 = {1, 0, 0, 0, 0};
+    ReduceOptions noFusion;
+    noFusion.fuseSeriesPlaces = noFusion.fuseSeriesTransitions = false;
+    Reduction r2 = reduceModel(m, noFusion);
+    assert(r2.reduced.places.size() == 3);       // p3 (không bao giờ có token) và p1 (trùng p2) bị bỏ
+    assert(r2.reduced.transitions.size() == 2);  // t2 (chết) và t3 (self-loop) bị bỏ
+    assert((r2.expand({0, 1, 0}) == Marking{0, 1, 1, 0, 0}));
+    cout << "   -> redundant places: OK" << endl;
+
+    cout << "✅ [PASS] Structural reductions hoat dong dung!" << endl;
+    return 0;
+}